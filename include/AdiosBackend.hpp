@@ -0,0 +1,63 @@
+/**
+ * @file AdiosBackend.hpp
+ * @brief This module declares the ADIOS 2 implementation of IOBackend
+ * @author Iole Bolognesi
+ *
+ * This module declares the AdiosBackend class, which writes and reads the
+ * metadata and the cipher-text as global ADIOS 2 variables, through the
+ * functions of adios.hpp.
+ **/
+
+#ifndef HEADER_ADIOSBACKEND
+#define HEADER_ADIOSBACKEND
+
+#include <optional>
+
+#include "IOBackend.hpp"
+
+/**
+ * @brief Declares AdiosBackend class.
+ */
+class AdiosBackend : public IOBackend
+{
+    public:
+        AdiosBackend(adios2::ADIOS &adios) : adios(adios) {};
+
+        std::string name() override { return "ADIOS2"; };
+
+        void openMetadata(const std::string file_name, bool write) override;
+        void closeMetadata() override;
+        size_t metadataSteps() override;
+        void openData(const std::string file_name, bool write) override;
+        void closeData() override;
+        size_t dataSteps() override;
+
+        void writeMetadata(size_t nproc, size_t rank, size_t CT_local_size,
+                        size_t CT_global_offset, size_t CTmeta_global_size,
+                        size_t CTmeta_local_size, size_t CTmeta_global_offset,
+                        std::vector<size_t> &files_sizes,
+                        std::vector<size_t> &files_offsets,
+                        std::vector<size_t> &files_orig_sizes,
+                        std::vector<size_t> &files_compressed_sizes,
+                        const std::string &files_names, size_t names_global_size,
+                        size_t names_global_offset) override;
+        ParallelCTMeta readMetadata(size_t step, size_t nproc, size_t rank,
+                        size_t CTmeta_global_offset, size_t CTmeta_local_size) override;
+        void writeData(const std::vector<DataBlock> &blocks, size_t shape) override;
+        std::vector<uint8_t> readData(size_t step, size_t count, size_t start) override;
+
+        void streamWriteData(BoundedQueue<std::vector<uint8_t>> &full_buffers,
+                        BoundedQueue<std::vector<uint8_t>> &free_buffers,
+                        const std::string file_name, size_t shape, size_t count,
+                        size_t start, size_t n_rounds) override;
+        GlobalCTMeta readGlobalMetadata(const std::string file_name) override;
+        std::vector<std::vector<uint8_t>> readDataRanges(const std::string file_name,
+                        const std::vector<size_t> &starts,
+                        const std::vector<size_t> &counts) override;
+
+    private:
+        adios2::ADIOS &adios;
+        std::optional<AdiosStream> metadata_stream;
+        std::optional<AdiosStream> data_stream;
+};
+#endif
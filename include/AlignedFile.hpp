@@ -0,0 +1,86 @@
+/**
+ * @file AlignedFile.hpp
+ * @brief This module declares files written and read through aligned buffers,
+ * optionally bypassing the page cache
+ * @author Iole Bolognesi
+ *
+ * This module declares the AlignedBufferPool class, a pool of page-aligned
+ * buffers reused across files, and the AlignedFile class, which writes and
+ * reads a file with pwrite and pread. With O_DIRECT, every transfer goes
+ * through a buffer of the pool, so that memory, file offsets and lengths
+ * are aligned as the kernel requires, whatever the alignment of the data.
+ **/
+
+#ifndef HEADER_ALIGNEDFILE
+#define HEADER_ALIGNEDFILE
+
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* Alignment of the buffers, offsets and lengths of O_DIRECT transfers */
+#define DIRECT_IO_ALIGNMENT 4096
+
+/* default size of the buffers of the pool */
+#define DEFAULT_ALIGNED_BUFFER_BYTES (4 * 1024 * 1024)
+
+/**
+ * @brief Declares AlignedBufferPool class.
+ */
+class AlignedBufferPool
+{
+    public:
+        /* Page-aligned buffer of buffer_bytes bytes */
+        struct FreeDeleter {
+            void operator()(unsigned char *buffer) const { std::free(buffer); };
+        };
+        using Buffer = std::unique_ptr<unsigned char, FreeDeleter>;
+
+        AlignedBufferPool(size_t buffer_bytes = DEFAULT_ALIGNED_BUFFER_BYTES);
+
+        Buffer take();
+        void give(Buffer buffer);
+        size_t bufferSize() const { return buffer_bytes; };
+
+    private:
+        size_t buffer_bytes;
+        std::mutex mutex;
+        std::vector<Buffer> free_buffers;
+};
+
+/**
+ * @brief Declares AlignedFile class.
+ */
+class AlignedFile
+{
+    public:
+        AlignedFile(const std::filesystem::path file_name, bool write, bool direct,
+                    AlignedBufferPool &pool);
+        ~AlignedFile();
+        AlignedFile(const AlignedFile &) = delete;
+        AlignedFile &operator=(const AlignedFile &) = delete;
+
+        void reserve(size_t length);
+        void writeContents(const unsigned char *data, size_t length);
+        void append(const unsigned char *data, size_t length);
+        void finish();
+        void read(unsigned char *data, size_t length, size_t offset);
+        size_t size();
+        bool isDirect() const { return direct; };
+
+    private:
+        void flushBuffer(size_t length);
+
+        std::filesystem::path file_name;
+        int file_descriptor;
+        bool direct;
+        AlignedBufferPool &pool;
+
+        /* Bytes appended since the last finish, and those not yet written */
+        AlignedBufferPool::Buffer buffer;
+        size_t filled = 0;
+        size_t written = 0;
+};
+#endif
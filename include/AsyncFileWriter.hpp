@@ -0,0 +1,62 @@
+/**
+ * @file AsyncFileWriter.hpp
+ * @brief This module declares a pool of threads writing files in the background
+ * @author Iole Bolognesi
+ *
+ * This module declares the AsyncFileWriter class. Files to be written are
+ * queued together with the buffer holding their contents, and written by a
+ * fixed set of writer threads, so that the caller can keep decrypting while 
+ * earlier files are flushed. The queue is bounded, and buffers are recycled 
+ * once written, so memory does not grow with the number of files.
+ **/
+
+#ifndef HEADER_ASYNCFILEWRITER
+#define HEADER_ASYNCFILEWRITER
+
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BoundedQueue.hpp"
+#include "fileIO.hpp"
+
+/* default number of files waiting to be written */
+#define DEFAULT_WRITE_QUEUE_DEPTH 16
+
+/**
+ * @brief Declares AsyncFileWriter class.
+ */
+class AsyncFileWriter
+{
+    public:
+        AsyncFileWriter(unsigned int n_writers, size_t queue_depth = DEFAULT_WRITE_QUEUE_DEPTH);
+        ~AsyncFileWriter();
+        AsyncFileWriter(const AsyncFileWriter &) = delete;
+        AsyncFileWriter &operator=(const AsyncFileWriter &) = delete;
+
+        ByteBuffer takeBuffer();
+        void recycleBuffer(ByteBuffer buffer);
+        void write(const std::filesystem::path file_name, ByteBuffer buffer, size_t length);
+        void finish();
+
+    private:
+        /* File to be written: the first length bytes of data */
+        struct WriteRequest {
+            std::filesystem::path file_name;
+            ByteBuffer data;
+            size_t length;
+        };
+
+        void writerLoop();
+        void rethrowError();
+
+        BoundedQueue<WriteRequest> requests;
+        std::vector<std::thread> writers;
+
+        std::mutex mutex;
+        std::vector<ByteBuffer> free_buffers;
+        std::exception_ptr error;
+};
+#endif
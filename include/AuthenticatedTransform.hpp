@@ -0,0 +1,128 @@
+/**
+ * @file AuthenticatedTransform.hpp
+ * @brief This module declares the AuthenticatedTransform interface through
+ * which files are encrypted and authenticated in chunks, and its Crypto++
+ * implementation
+ * @author Iole Bolognesi
+ *
+ * This module declares the AuthenticatedTransform class, a type-erased
+ * authenticated encryption object (AES-GCM, ChaCha20-Poly1305), and the
+ * CryptoAuthenticator template implementing it for a pair of Crypto++
+ * encryption and decryption objects.
+ *
+ * A file is split into chunks of AUTH_CHUNK_BYTES, each encrypted and
+ * authenticated on its own, and the tags of its chunks follow its
+ * cipher-text. The nonce of a chunk is the IV of the file with its last 8
+ * bytes XORed with the offset of the chunk within the file, and the
+ * associated data marks the last chunk of the file, so chunks cannot be
+ * reordered or dropped. Chunks are therefore
+ * decrypted and verified independently, in any order.
+ **/
+
+#ifndef HEADER_AUTHENTICATEDTRANSFORM
+#define HEADER_AUTHENTICATEDTRANSFORM
+
+#include <memory>
+#include <string>
+#include <secblock.h>
+
+/* Size of the tag of each chunk (bytes) */
+#define N_TAG_BYTES 16
+
+/* Size of the chunks authenticated by a single tag (bytes) */
+#define AUTH_CHUNK_BYTES (64 * 1024)
+
+size_t authenticatedChunks(size_t plaintext_size);
+size_t authenticatedSize(size_t plaintext_size);
+size_t authenticatedPayloadSize(size_t encrypted_size);
+
+/**
+ * @brief Declares AuthenticatedTransform abstract class.
+ */
+class AuthenticatedTransform
+{
+    public:
+        AuthenticatedTransform(const CryptoPP::SecByteBlock &iv) : iv(iv) {};
+        virtual ~AuthenticatedTransform() = default;
+
+        virtual std::string algorithmName() = 0;
+        virtual void seal(unsigned char *output, unsigned char *tag, const unsigned char *input,
+                        size_t length, const unsigned char *nonce, const unsigned char *aad,
+                        size_t aad_length) = 0;
+        virtual bool open(unsigned char *output, const unsigned char *tag,
+                        const unsigned char *input, size_t length, const unsigned char *nonce,
+                        const unsigned char *aad, size_t aad_length) = 0;
+        virtual std::unique_ptr<AuthenticatedTransform> clone() = 0;
+
+        void encryptChunk(unsigned char *output, const unsigned char *input,
+                        size_t plaintext_size, size_t chunk,
+                        const CryptoPP::SecByteBlock &file_iv);
+        void decryptChunk(unsigned char *output, const unsigned char *input,
+                        size_t plaintext_size, size_t chunk,
+                        const CryptoPP::SecByteBlock &file_iv);
+
+    protected:
+        CryptoPP::SecByteBlock iv;
+
+    private:
+        void chunkNonce(unsigned char *nonce, const CryptoPP::SecByteBlock &file_iv,
+                        size_t chunk_offset);
+};
+
+/**
+ * @brief Declares CryptoAuthenticator class, which wraps the Crypto++
+ * encryption and decryption objects of an authenticated mode, keyed with a
+ * key and the IV the nonces are derived from.
+ */
+template <typename Encryption, typename Decryption>
+class CryptoAuthenticator : public AuthenticatedTransform
+{
+    public:
+        CryptoAuthenticator(const CryptoPP::SecByteBlock &key, const CryptoPP::SecByteBlock &iv)
+            : AuthenticatedTransform(iv), key(key) {
+
+            encryption.SetKeyWithIV(key, key.size(), iv, iv.size());
+            decryption.SetKeyWithIV(key, key.size(), iv, iv.size());
+        };
+
+        std::string algorithmName() override { return encryption.AlgorithmName(); };
+
+        void seal(unsigned char *output, unsigned char *tag, const unsigned char *input,
+                size_t length, const unsigned char *nonce, const unsigned char *aad,
+                size_t aad_length) override {
+            encryption.EncryptAndAuthenticate(output, tag, N_TAG_BYTES, nonce,
+                                            static_cast<int>(iv.size()), aad, aad_length,
+                                            input, length);
+        };
+
+        bool open(unsigned char *output, const unsigned char *tag, const unsigned char *input,
+                size_t length, const unsigned char *nonce, const unsigned char *aad,
+                size_t aad_length) override {
+            return decryption.DecryptAndVerify(output, tag, N_TAG_BYTES, nonce,
+                                            static_cast<int>(iv.size()), aad, aad_length,
+                                            input, length);
+        };
+
+        std::unique_ptr<AuthenticatedTransform> clone() override {
+            return std::make_unique<CryptoAuthenticator<Encryption, Decryption>>(key, iv);
+        };
+
+    private:
+        Encryption encryption;
+        Decryption decryption;
+        CryptoPP::SecByteBlock key;
+};
+
+/**
+ * @brief Creates an AuthenticatedTransform around new Crypto++ objects.
+ *
+ * @param key  Key of the objects.
+ * @param iv   IV the nonces of the chunks are derived from.
+ * @return The keyed transform.
+ */
+template <typename Encryption, typename Decryption>
+std::unique_ptr<AuthenticatedTransform> makeAuthenticator(const CryptoPP::SecByteBlock &key,
+                                                        const CryptoPP::SecByteBlock &iv){
+    return std::make_unique<CryptoAuthenticator<Encryption, Decryption>>(key, iv);
+}
+#endif
@@ -0,0 +1,60 @@
+/**
+ * @file BatchedReader.hpp
+ * @brief This module declares a reader keeping many file reads in flight
+ * @author Iole Bolognesi
+ *
+ * This module declares the BatchedReader class, which reads a list of files
+ * in pieces of at most READ_BUFFER_BYTES and hands each piece to a consumer
+ * function. When built with USE_IO_URING, up to queue_depth reads are kept
+ * in flight through io_uring, into buffers registered with the kernel, and
+ * pieces are handed over in completion order (or in file order, if 
+ * requested). Otherwise the files are read one piece at a time with pread.
+ **/
+
+#ifndef HEADER_BATCHEDREADER
+#define HEADER_BATCHEDREADER
+
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+#include "fileIO.hpp"
+
+/* default number of reads kept in flight */
+#define DEFAULT_READ_DEPTH 32
+
+/* size of each read buffer (bytes), a multiple of the cipher block size */
+#define READ_BUFFER_BYTES (1024 * 1024)
+
+/**
+ * @brief Declares BatchedReader class.
+ */
+class BatchedReader
+{
+    public:
+        /* Receives length bytes of a file, starting at file_offset. The data
+        is only valid until the function returns */
+        using Consumer = std::function<void(size_t file_index, size_t file_offset,
+                                            const unsigned char *data, size_t length)>;
+
+        BatchedReader(unsigned int queue_depth = DEFAULT_READ_DEPTH, bool in_order = false);
+
+        static bool usesIoUring();
+        void readFiles(const std::vector<std::filesystem::path> &files,
+                    const std::vector<size_t> &files_sizes, const Consumer &consume);
+
+    private:
+        void readSequential(const std::vector<std::filesystem::path> &files,
+                    const std::vector<size_t> &files_sizes, const Consumer &consume);
+#ifdef USE_IO_URING
+        void readIoUring(const std::vector<std::filesystem::path> &files,
+                    const std::vector<size_t> &files_sizes, const Consumer &consume);
+#endif
+
+        unsigned int queue_depth;
+        bool in_order;
+
+        /* queue_depth buffers of READ_BUFFER_BYTES, one per read in flight */
+        ByteBuffer buffers;
+};
+#endif
@@ -0,0 +1,82 @@
+/**
+ * @file BoundedQueue.hpp
+ * @brief This module declares and defines a thread-safe bounded FIFO queue
+ * @author Iole Bolognesi
+ *
+ * This module provides the BoundedQueue class template, used to hand buffers
+ * between the stages of a pipeline running on different threads. Producers
+ * block while the queue is full, consumers block while it is empty, and
+ * closing the queue releases all consumers once the queue has drained.
+ **/
+
+#ifndef HEADER_BOUNDEDQUEUE
+#define HEADER_BOUNDEDQUEUE
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+/**
+ * @brief Declares and defines BoundedQueue class.
+ */
+template <typename T>
+class BoundedQueue
+{
+    public:
+        BoundedQueue(size_t capacity) : capacity(capacity == 0 ? 1 : capacity) {};
+
+        /**
+         * @brief Appends an item, waiting while the queue is full.
+         *
+         * @param item  Item to append.
+         * @return true if the item was appended; false if the queue is closed.
+         */
+        bool push(T item) {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+            if (closed) {
+                return false;
+            }
+            items.push_back(std::move(item));
+            not_empty.notify_one();
+            return true;
+        };
+
+        /**
+         * @brief Removes the oldest item, waiting while the queue is empty.
+         *
+         * @return The oldest item; std::nullopt if the queue is closed and empty.
+         */
+        std::optional<T> pop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_empty.wait(lock, [this] { return closed || !items.empty(); });
+            if (items.empty()) {
+                return std::nullopt;
+            }
+            T item = std::move(items.front());
+            items.pop_front();
+            not_full.notify_one();
+            return item;
+        };
+
+        /**
+         * @brief Closes the queue: further pushes fail and pops return the
+         * remaining items, then std::nullopt.
+         */
+        void close() {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            not_full.notify_all();
+            not_empty.notify_all();
+        };
+
+    private:
+        size_t capacity;
+        std::deque<T> items;
+        bool closed = false;
+        std::mutex mutex;
+        std::condition_variable not_full;
+        std::condition_variable not_empty;
+};
+#endif
@@ -0,0 +1,50 @@
+/**
+ * @file ChunkedEngine.hpp
+ * @brief This module declares the chunked encryption engine for random-access
+ * ciphers
+ * @author Iole Bolognesi
+ *
+ * This module declares the ChunkedEngine class. For ciphers whose keystream
+ * can be computed from the key, the IV and a byte position (CTR modes and
+ * ChaCha20), a file is split into fixed-size chunks that are encrypted on
+ * the threads of a ThreadPool, each worker restarting its own keystream from
+ * the IV of the file and seeking it to the offset of the chunk it processes.
+ **/
+
+#ifndef HEADER_CHUNKEDENGINE
+#define HEADER_CHUNKEDENGINE
+
+#include <memory>
+#include <vector>
+
+#include "Cipher.hpp"
+#include "ThreadPool.hpp"
+
+/* default size of the chunks processed by a single worker (bytes) */
+#define DEFAULT_CHUNK_BYTES (4 * 1024 * 1024)
+
+/**
+ * @brief Declares ChunkedEngine class.
+ */
+class ChunkedEngine
+{
+    public:
+        ChunkedEngine(Cipher &cipher, ThreadPool &pool, size_t chunk_bytes = DEFAULT_CHUNK_BYTES);
+
+        bool isEnabled() const { return enabled; };
+
+        void encrypt(unsigned char *output, const unsigned char *input, size_t length,
+                    const CryptoPP::SecByteBlock &file_iv, size_t file_offset);
+        void decrypt(unsigned char *output, const unsigned char *input, size_t length,
+                    const CryptoPP::SecByteBlock &file_iv, size_t file_offset);
+
+    private:
+        ThreadPool &pool;
+        size_t chunk_bytes;
+        bool enabled;
+
+        /* one Crypto++ object per worker, each with its own keystream position */
+        std::vector<std::unique_ptr<StreamTransform>> encryptors;
+        std::vector<std::unique_ptr<StreamTransform>> decryptors;
+};
+#endif
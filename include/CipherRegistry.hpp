@@ -0,0 +1,160 @@
+/**
+ * @file CipherRegistry.hpp
+ * @brief This module declares the table of the ciphers and modes that can
+ * be selected, and the lookup of their names
+ * @author Iole Bolognesi
+ *
+ * This module declares cipher_registry, the single table of the supported
+ * combinations of cipher and mode, each with its name and the function
+ * creating its CipherSpec. A combination is added with one line of the
+ * table. Names are found through a perfect hash of the table, built at
+ * compile time.
+ **/
+
+#ifndef HEADER_CIPHERREGISTRY
+#define HEADER_CIPHERREGISTRY
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "CipherSpec.hpp"
+
+/* Row of the table: the name of a cipher and mode and its constructor */
+struct CipherEntry {
+    std::string_view name;
+    std::unique_ptr<Cipher> (*create)();
+};
+
+/**
+ * @brief Creates the Cipher of a cipher in a mode.
+ */
+template <typename BlockCipher, typename Mode>
+std::unique_ptr<Cipher> createCipherSpec(){
+    return std::make_unique<CipherSpec<BlockCipher, Mode>>();
+}
+
+/**
+ * @brief Builds the row of the table of a cipher in a mode.
+ */
+template <typename BlockCipher, typename Mode>
+constexpr CipherEntry registryEntry(std::string_view name){
+    return {name, &createCipherSpec<BlockCipher, Mode>};
+}
+
+inline constexpr CipherEntry cipher_registry[] = {
+    registryEntry<CryptoPP::AES, CbcMode>("AES_CBC"),
+    registryEntry<CryptoPP::AES, CfbMode>("AES_CFB"),
+    registryEntry<CryptoPP::AES, OfbMode>("AES_OFB"),
+    registryEntry<CryptoPP::AES, CtrMode>("AES_CTR"),
+    registryEntry<CryptoPP::AES, EcbMode>("AES_ECB"),
+    registryEntry<CryptoPP::AES, GcmMode>("AES_GCM"),
+
+    registryEntry<CryptoPP::Serpent, CbcMode>("SERPENT_CBC"),
+    registryEntry<CryptoPP::Serpent, CfbMode>("SERPENT_CFB"),
+    registryEntry<CryptoPP::Serpent, OfbMode>("SERPENT_OFB"),
+    registryEntry<CryptoPP::Serpent, CtrMode>("SERPENT_CTR"),
+    registryEntry<CryptoPP::Serpent, EcbMode>("SERPENT_ECB"),
+
+    registryEntry<CryptoPP::MARS, CbcMode>("MARS_CBC"),
+    registryEntry<CryptoPP::MARS, CfbMode>("MARS_CFB"),
+    registryEntry<CryptoPP::MARS, OfbMode>("MARS_OFB"),
+    registryEntry<CryptoPP::MARS, CtrMode>("MARS_CTR"),
+    registryEntry<CryptoPP::MARS, EcbMode>("MARS_ECB"),
+
+    registryEntry<CryptoPP::RC6, CbcMode>("RC6_CBC"),
+    registryEntry<CryptoPP::RC6, CfbMode>("RC6_CFB"),
+    registryEntry<CryptoPP::RC6, OfbMode>("RC6_OFB"),
+    registryEntry<CryptoPP::RC6, CtrMode>("RC6_CTR"),
+    registryEntry<CryptoPP::RC6, EcbMode>("RC6_ECB"),
+
+    registryEntry<CryptoPP::Twofish, CbcMode>("TWOFISH_CBC"),
+    registryEntry<CryptoPP::Twofish, CfbMode>("TWOFISH_CFB"),
+    registryEntry<CryptoPP::Twofish, OfbMode>("TWOFISH_OFB"),
+    registryEntry<CryptoPP::Twofish, CtrMode>("TWOFISH_CTR"),
+    registryEntry<CryptoPP::Twofish, EcbMode>("TWOFISH_ECB"),
+
+    registryEntry<CryptoPP::ChaCha, StreamMode>("CHACHA20"),
+    registryEntry<CryptoPP::ChaCha20Poly1305, AeadStreamMode>("CHACHA20_POLY1305"),
+};
+
+constexpr size_t registry_size = std::size(cipher_registry);
+
+/* Buckets of the perfect hash, at least four per name so that a seed
+placing every name in its own bucket is found after a few attempts */
+constexpr size_t registry_buckets = 128;
+static_assert(registry_size * 4 <= registry_buckets && registry_size < 255,
+            "The perfect hash of the cipher names needs more buckets");
+
+/**
+ * @brief Hashes a name with FNV-1a, starting from a seed.
+ */
+constexpr uint32_t hashCipherName(std::string_view name, uint32_t seed){
+
+    uint32_t hash = 2166136261u ^ seed;
+
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return (hash ^ (hash >> 16)) % registry_buckets;
+}
+
+/* Perfect hash of the names: the seed, and the row of each bucket,
+registry_size for an empty bucket */
+struct CipherNameHash {
+    uint32_t seed;
+    std::array<uint8_t, registry_buckets> rows;
+};
+
+/**
+ * @brief Finds the first seed for which no two names of the table share a
+ * bucket.
+ */
+constexpr CipherNameHash buildCipherNameHash(){
+
+    for (uint32_t seed = 0; ; seed++) {
+
+        CipherNameHash table{seed, {}};
+        bool collision = false;
+
+        for (size_t bucket = 0; bucket < registry_buckets; bucket++) {
+            table.rows[bucket] = registry_size;
+        }
+
+        for (size_t row = 0; row < registry_size && !collision; row++) {
+            uint32_t bucket = hashCipherName(cipher_registry[row].name, seed);
+            collision = table.rows[bucket] != registry_size;
+            table.rows[bucket] = static_cast<uint8_t>(row);
+        }
+
+        if (!collision) {
+            return table;
+        }
+    }
+}
+
+inline constexpr CipherNameHash cipher_name_hash = buildCipherNameHash();
+
+/**
+ * @brief Finds a cipher and mode by name.
+ *
+ * @param name  Name of the cipher and mode, e.g. "AES_CTR".
+ * @return The row of the table; std::nullopt if the name is not in it.
+ */
+constexpr std::optional<size_t> findCipher(std::string_view name){
+
+    size_t row = cipher_name_hash.rows[hashCipherName(name, cipher_name_hash.seed)];
+
+    if (row == registry_size || cipher_registry[row].name != name) {
+        return std::nullopt;
+    }
+    return row;
+}
+
+static_assert(findCipher("AES_CTR") && !findCipher("AES_XYZ"),
+            "The perfect hash of the cipher names is inconsistent");
+#endif
@@ -0,0 +1,221 @@
+/**
+ * @file CipherSpec.hpp
+ * @brief This module declares the modes of operation and the CipherSpec
+ * template implementing the Cipher class for any cipher and mode
+ * @author Iole Bolognesi
+ *
+ * This module declares one tag per mode of operation, holding the Crypto++
+ * types of the mode and its properties, and the CipherSpec template, which
+ * implements the Cipher class for a Crypto++ block cipher in a mode, or for
+ * a stream cipher with the StreamMode or AeadStreamMode tag. The
+ * combinations that can be selected are listed in CipherRegistry.hpp.
+ **/
+
+#ifndef HEADER_CIPHERSPEC
+#define HEADER_CIPHERSPEC
+
+#include "Cipher.hpp"
+
+/**
+ * @brief Declares the CBC mode, which pads and chains the cipher-text.
+ */
+struct CbcMode {
+    template <typename BlockCipher>
+    using Encryption = typename CryptoPP::CBC_Mode<BlockCipher>::Encryption;
+    template <typename BlockCipher>
+    using Decryption = typename CryptoPP::CBC_Mode<BlockCipher>::Decryption;
+
+    static constexpr int iv_bytes = N_BLOCK_BYTES;
+    static constexpr bool uses_iv = true;
+    static constexpr bool requires_padding = true;
+    static constexpr bool supports_seeking = false;
+    static constexpr bool independent_blocks = false;
+    static constexpr bool chains_ciphertext = true;
+    static constexpr bool authenticated = false;
+};
+
+/**
+ * @brief Declares the CFB mode, which chains the cipher-text.
+ */
+struct CfbMode {
+    template <typename BlockCipher>
+    using Encryption = typename CryptoPP::CFB_Mode<BlockCipher>::Encryption;
+    template <typename BlockCipher>
+    using Decryption = typename CryptoPP::CFB_Mode<BlockCipher>::Decryption;
+
+    static constexpr int iv_bytes = N_BLOCK_BYTES;
+    static constexpr bool uses_iv = true;
+    static constexpr bool requires_padding = false;
+    static constexpr bool supports_seeking = false;
+    static constexpr bool independent_blocks = false;
+    static constexpr bool chains_ciphertext = true;
+    static constexpr bool authenticated = false;
+};
+
+/**
+ * @brief Declares the OFB mode, whose keystream is generated in sequence.
+ */
+struct OfbMode {
+    template <typename BlockCipher>
+    using Encryption = typename CryptoPP::OFB_Mode<BlockCipher>::Encryption;
+    template <typename BlockCipher>
+    using Decryption = typename CryptoPP::OFB_Mode<BlockCipher>::Decryption;
+
+    static constexpr int iv_bytes = N_BLOCK_BYTES;
+    static constexpr bool uses_iv = true;
+    static constexpr bool requires_padding = false;
+    static constexpr bool supports_seeking = false;
+    static constexpr bool independent_blocks = false;
+    static constexpr bool chains_ciphertext = false;
+    static constexpr bool authenticated = false;
+};
+
+/**
+ * @brief Declares the CTR mode, whose keystream is random-access.
+ */
+struct CtrMode {
+    template <typename BlockCipher>
+    using Encryption = typename CryptoPP::CTR_Mode<BlockCipher>::Encryption;
+    template <typename BlockCipher>
+    using Decryption = typename CryptoPP::CTR_Mode<BlockCipher>::Decryption;
+
+    static constexpr int iv_bytes = N_BLOCK_BYTES;
+    static constexpr bool uses_iv = true;
+    static constexpr bool requires_padding = false;
+    static constexpr bool supports_seeking = true;
+    static constexpr bool independent_blocks = false;
+    static constexpr bool chains_ciphertext = false;
+    static constexpr bool authenticated = false;
+};
+
+/**
+ * @brief Declares the ECB mode, which pads and encrypts every block
+ * independently, without an IV.
+ */
+struct EcbMode {
+    template <typename BlockCipher>
+    using Encryption = typename CryptoPP::ECB_Mode<BlockCipher>::Encryption;
+    template <typename BlockCipher>
+    using Decryption = typename CryptoPP::ECB_Mode<BlockCipher>::Decryption;
+
+    static constexpr int iv_bytes = N_BLOCK_BYTES;
+    static constexpr bool uses_iv = false;
+    static constexpr bool requires_padding = true;
+    static constexpr bool supports_seeking = false;
+    static constexpr bool independent_blocks = true;
+    static constexpr bool chains_ciphertext = false;
+    static constexpr bool authenticated = false;
+};
+
+/**
+ * @brief Declares the use of a stream cipher on its own (ChaCha20), whose
+ * keystream is random-access.
+ */
+struct StreamMode {
+    template <typename StreamCipher>
+    using Encryption = typename StreamCipher::Encryption;
+    template <typename StreamCipher>
+    using Decryption = typename StreamCipher::Decryption;
+
+    static constexpr int iv_bytes = 12;
+    static constexpr bool uses_iv = true;
+    static constexpr bool requires_padding = false;
+    static constexpr bool supports_seeking = true;
+    static constexpr bool independent_blocks = false;
+    static constexpr bool chains_ciphertext = false;
+    static constexpr bool authenticated = false;
+};
+
+/**
+ * @brief Declares the GCM mode, which encrypts and authenticates each chunk
+ * of a file with a 12-byte nonce (see AuthenticatedTransform.hpp).
+ */
+struct GcmMode {
+    template <typename BlockCipher>
+    using Encryption = typename CryptoPP::GCM<BlockCipher>::Encryption;
+    template <typename BlockCipher>
+    using Decryption = typename CryptoPP::GCM<BlockCipher>::Decryption;
+
+    static constexpr int iv_bytes = 12;
+    static constexpr bool uses_iv = true;
+    static constexpr bool requires_padding = false;
+    static constexpr bool supports_seeking = false;
+    static constexpr bool independent_blocks = false;
+    static constexpr bool chains_ciphertext = false;
+    static constexpr bool authenticated = true;
+};
+
+/**
+ * @brief Declares the use of an authenticated stream cipher on its own 
+ * (ChaCha20-Poly1305), in chunks like GcmMode.
+ */
+struct AeadStreamMode {
+    template <typename StreamCipher>
+    using Encryption = typename StreamCipher::Encryption;
+    template <typename StreamCipher>
+    using Decryption = typename StreamCipher::Decryption;
+
+    static constexpr int iv_bytes = 12;
+    static constexpr bool uses_iv = true;
+    static constexpr bool requires_padding = false;
+    static constexpr bool supports_seeking = false;
+    static constexpr bool independent_blocks = false;
+    static constexpr bool chains_ciphertext = false;
+    static constexpr bool authenticated = true;
+};
+
+/* Key length of each cipher in bytes */
+template <typename BlockCipher>
+constexpr int cipher_key_bytes = N_KEY_BYTES;
+
+template <>
+constexpr int cipher_key_bytes<CryptoPP::MARS> = 56;
+
+/**
+ * @brief Declares CipherSpec class, the Cipher of a cipher in a mode.
+ */
+template <typename BlockCipher, typename Mode>
+class CipherSpec : public Cipher
+{
+    public:
+        CipherSpec() : Cipher(cipher_key_bytes<BlockCipher>, Mode::iv_bytes) {};
+
+        /* Authenticated modes only encrypt through their AuthenticatedTransform */
+        std::unique_ptr<StreamTransform> createEncryptor() override {
+            if constexpr (Mode::authenticated) {
+                return nullptr;
+            }
+            else {
+                return makeTransform<typename Mode::template Encryption<BlockCipher>>(
+                                    key, Mode::uses_iv ? iv : CryptoPP::SecByteBlock());
+            }
+        };
+
+        std::unique_ptr<StreamTransform> createDecryptor() override {
+            if constexpr (Mode::authenticated) {
+                return nullptr;
+            }
+            else {
+                return makeTransform<typename Mode::template Decryption<BlockCipher>>(
+                                    key, Mode::uses_iv ? iv : CryptoPP::SecByteBlock());
+            }
+        };
+
+        std::unique_ptr<AuthenticatedTransform> createAuthenticator() override {
+            if constexpr (Mode::authenticated) {
+                return makeAuthenticator<typename Mode::template Encryption<BlockCipher>,
+                                        typename Mode::template Decryption<BlockCipher>>(key, iv);
+            }
+            else {
+                return nullptr;
+            }
+        };
+
+        bool requiresPadding() override { return Mode::requires_padding; };
+        bool supportsSeeking() override { return Mode::supports_seeking; };
+        bool hasIndependentBlocks() override { return Mode::independent_blocks; };
+        bool chainsCiphertext() override { return Mode::chains_ciphertext; };
+        bool isAuthenticated() override { return Mode::authenticated; };
+        bool usesIV() override { return Mode::uses_iv; };
+};
+#endif
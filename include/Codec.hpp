@@ -0,0 +1,42 @@
+/**
+ * @file Codec.hpp
+ * @brief This module declares the base Codec interface for the compression
+ * of files before encryption
+ * @author Iole Bolognesi
+ *
+ * This module declares the Codec class, through which each file is
+ * compressed before it is encrypted, since cipher-text does not compress.
+ * A file that does not shrink is stored as it is, which the reader tells
+ * from its stored size being equal to its original size.
+ **/
+
+#ifndef HEADER_CODEC
+#define HEADER_CODEC
+
+#include <filesystem>
+#include <string>
+
+#include "fileIO.hpp"
+
+/**
+ * @brief Declares Codec abstract class.
+ */
+class Codec
+{
+    public:
+        virtual ~Codec() = default;
+
+        virtual std::string name() = 0;
+        virtual size_t maxCompressedSize(size_t length) = 0;
+        virtual size_t compress(unsigned char *output, size_t capacity,
+                                const unsigned char *input, size_t length) = 0;
+        virtual void decompress(unsigned char *output, size_t length,
+                                const unsigned char *input, size_t compressed_length) = 0;
+
+        ByteBuffer compressFile(const std::filesystem::path file_name, size_t file_size,
+                                bool mapped);
+        ByteBuffer compressBuffer(ByteBuffer contents);
+        void expand(unsigned char *output, size_t orig_size, const unsigned char *input,
+                    size_t stored_size);
+};
+#endif
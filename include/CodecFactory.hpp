@@ -0,0 +1,29 @@
+/**
+ * @file CodecFactory.hpp
+ * @brief This module declares the CodecFactory class and the CodecType enum
+ * @author Iole Bolognesi
+ *
+ * This module declares the CodecType enumeration and a factory class to 
+ * construct concrete Codec implementations based on a CodecType input value.
+ */
+
+#ifndef HEADER_CODECFACTORY
+#define HEADER_CODECFACTORY
+
+#include <memory>
+
+#include "Codec.hpp"
+
+enum CodecType {
+    CODEC_NONE, CODEC_ZSTD, CODEC_LZ4
+};
+
+/**
+ * @brief Declares factory class. 
+ */
+class CodecFactory
+{
+    public:
+        std::unique_ptr<Codec> createCodec(CodecType type, int level);
+};
+#endif 
@@ -0,0 +1,91 @@
+/**
+ * @file CryptoStage.hpp
+ * @brief This module declares the encryption and decryption stage shared by
+ * the serial and parallel pipelines
+ * @author Iole Bolognesi
+ *
+ * This module declares the CryptoStage class, which owns the Crypto++
+ * encryptors and decryptors of a Cipher and the ChunkedEngine, and routes 
+ * each buffer to the chunked engine or to a single ProcessData call. It also
+ * applies PKCS#7 padding for the ciphers that require it. The threads of a
+ * process are used either on the chunks of each file or on whole files.
+ * Every file is processed from its own IV (see Cipher::fileIV), so buffers
+ * are given by the index of their file and their offset within it.
+ * Authenticated modes encrypt whole files only, in chunks that each carry 
+ * a tag (see AuthenticatedTransform.hpp).
+ **/
+
+#ifndef HEADER_CRYPTOSTAGE
+#define HEADER_CRYPTOSTAGE
+
+#include <memory>
+
+#include "Cipher.hpp"
+#include "ChunkedEngine.hpp"
+#include "ThreadPool.hpp"
+
+/* Ways of using the threads of a process */
+enum ThreadingType {
+    THREADS_CHUNKS, THREADS_FILES
+};
+
+/**
+ * @brief Declares CryptoStage class.
+ */
+class CryptoStage
+{
+    public:
+        CryptoStage(Cipher &cipher, ThreadPool &pool, size_t chunk_bytes = DEFAULT_CHUNK_BYTES,
+                    ThreadingType threading = THREADS_CHUNKS);
+
+        std::string algorithmName();
+        bool isChunked() const { return (engine && engine->isEnabled()) || authenticated_chunks; };
+        bool isAuthenticated() const { return authenticated; };
+        bool isOrderIndependent() const { return order_independent; };
+        bool isFileParallel() const { return file_parallel; };
+        size_t encryptedSize(size_t plaintext_size);
+
+        void forEachFile(size_t n_files, const ThreadPool::Task &task);
+
+        void encrypt(unsigned char *output, const unsigned char *input, size_t length,
+                    size_t file_index, size_t file_offset, unsigned int worker_id = 0);
+        void encryptPadded(unsigned char *output, const unsigned char *input,
+                    size_t plaintext_size, size_t file_index, size_t file_offset,
+                    unsigned int worker_id = 0);
+        void decrypt(unsigned char *output, const unsigned char *input,
+                    size_t length, size_t file_index, unsigned int worker_id = 0);
+
+    private:
+        Cipher &cipher;
+        ThreadPool &pool;
+
+        /* whether the buffers of a file can be processed in any order, given 
+        their offsets */
+        bool order_independent;
+        bool file_parallel;
+
+        /* whether files are authenticated in chunks, and the chunks of a 
+        file processed across the pool */
+        bool authenticated;
+        bool authenticated_chunks;
+
+        /* one Crypto++ object per worker when files are processed in parallel, 
+        a single one otherwise */
+        std::vector<std::unique_ptr<StreamTransform>> encryptors;
+        std::vector<std::unique_ptr<StreamTransform>> decryptors;
+        std::vector<std::unique_ptr<AuthenticatedTransform>> authenticators;
+        std::unique_ptr<ChunkedEngine> engine;
+
+        /* IV of the last file seen by each worker, so that it is derived 
+        once per file rather than once per buffer */
+        std::vector<size_t> cached_files;
+        std::vector<CryptoPP::SecByteBlock> cached_ivs;
+
+        const CryptoPP::SecByteBlock &fileIV(size_t file_index, unsigned int worker_id);
+        void positionObject(StreamTransform &crypto_object, size_t file_index, 
+                            size_t file_offset, unsigned int worker_id);
+        void processAuthenticated(unsigned char *output, const unsigned char *input,
+                                size_t plaintext_size, size_t file_index, 
+                                unsigned int worker_id, bool encrypting);
+};
+#endif
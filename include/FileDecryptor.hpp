@@ -0,0 +1,32 @@
+/**
+ * @file FileDecryptor.hpp
+ * @brief This module declares the decryption of single files out of a
+ * local cipher-text
+ * @author Iole Bolognesi
+ *
+ * This module declares the FileDecryptor class, which decrypts the
+ * cipher-text of one file without decrypting the files before it, by
+ * starting a new Crypto++ decryptor from the IV of the file, or by
+ * verifying its chunks for authenticated modes.
+ **/
+
+#ifndef HEADER_FILEDECRYPTOR
+#define HEADER_FILEDECRYPTOR
+
+#include "Cipher.hpp"
+
+/**
+ * @brief Declares FileDecryptor class.
+ */
+class FileDecryptor
+{
+    public:
+        FileDecryptor(Cipher &cipher) : cipher(cipher) {};
+
+        void decrypt(unsigned char *output, const unsigned char *input, size_t length,
+                    size_t file_index);
+
+    private:
+        Cipher &cipher;
+};
+#endif
@@ -0,0 +1,66 @@
+/**
+ * @file IOBackend.hpp
+ * @brief This module declares the IOBackend abstract class
+ * @author Iole Bolognesi
+ *
+ * This module declares the interface through which the parallel pipeline and
+ * bin/extract write and read the metadata and the cipher-text in parallel,
+ * so that the I/O library can be chosen at runtime. A file is opened for
+ * writing or for reading and can be kept open across iterations, each
+ * iteration writing or reading one step.
+ **/
+
+#ifndef HEADER_IOBACKEND
+#define HEADER_IOBACKEND
+
+#include <string>
+#include <vector>
+
+#include "libpar.hpp"
+#include "adios.hpp"
+#include "BoundedQueue.hpp"
+
+/**
+ * @brief Declares IOBackend abstract class.
+ */
+class IOBackend
+{
+    public:
+        virtual ~IOBackend() = default;
+
+        virtual std::string name() = 0;
+
+        /* Files kept open across steps */
+        virtual void openMetadata(const std::string file_name, bool write) = 0;
+        virtual void closeMetadata() = 0;
+        virtual size_t metadataSteps() = 0;
+        virtual void openData(const std::string file_name, bool write) = 0;
+        virtual void closeData() = 0;
+        virtual size_t dataSteps() = 0;
+
+        /* One step of the open files */
+        virtual void writeMetadata(size_t nproc, size_t rank, size_t CT_local_size,
+                                size_t CT_global_offset, size_t CTmeta_global_size,
+                                size_t CTmeta_local_size, size_t CTmeta_global_offset,
+                                std::vector<size_t> &files_sizes,
+                                std::vector<size_t> &files_offsets,
+                                std::vector<size_t> &files_orig_sizes,
+                                std::vector<size_t> &files_compressed_sizes,
+                                const std::string &files_names, size_t names_global_size,
+                                size_t names_global_offset) = 0;
+        virtual ParallelCTMeta readMetadata(size_t step, size_t nproc, size_t rank,
+                                size_t CTmeta_global_offset, size_t CTmeta_local_size) = 0;
+        virtual void writeData(const std::vector<DataBlock> &blocks, size_t shape) = 0;
+        virtual std::vector<uint8_t> readData(size_t step, size_t count, size_t start) = 0;
+
+        /* Whole files */
+        virtual void streamWriteData(BoundedQueue<std::vector<uint8_t>> &full_buffers,
+                                BoundedQueue<std::vector<uint8_t>> &free_buffers,
+                                const std::string file_name, size_t shape, size_t count,
+                                size_t start, size_t n_rounds) = 0;
+        virtual GlobalCTMeta readGlobalMetadata(const std::string file_name) = 0;
+        virtual std::vector<std::vector<uint8_t>> readDataRanges(const std::string file_name,
+                                const std::vector<size_t> &starts,
+                                const std::vector<size_t> &counts) = 0;
+};
+#endif
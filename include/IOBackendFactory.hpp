@@ -0,0 +1,31 @@
+/**
+ * @file IOBackendFactory.hpp
+ * @brief This module declares the IOBackendFactory class and the IOBackendType enum
+ * @author Iole Bolognesi
+ *
+ * This module declares the IOBackendType enumeration and a factory class to 
+ * construct concrete IOBackend implementations based on an IOBackendType 
+ * input value.
+ */
+
+#ifndef HEADER_IOBACKENDFACTORY
+#define HEADER_IOBACKENDFACTORY
+
+#include <memory>
+
+#include "IOBackend.hpp"
+
+enum IOBackendType {
+    BACKEND_ADIOS, BACKEND_MPIIO, BACKEND_POSIX
+};
+
+/**
+ * @brief Declares factory class. 
+ */
+class IOBackendFactory
+{
+    public:
+        std::unique_ptr<IOBackend> createBackend(IOBackendType type, adios2::ADIOS &adios,
+                                                const std::string mpiio_hints, bool direct_io);
+};
+#endif 
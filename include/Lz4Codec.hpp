@@ -0,0 +1,37 @@
+/**
+ * @file Lz4Codec.hpp
+ * @brief This module declares the LZ4 implementation of Codec
+ * @author Iole Bolognesi
+ *
+ * This module declares the Lz4Codec class, available when built with
+ * USE_LZ4. Each file is compressed as a single LZ4 block, whose original
+ * size is kept in the metadata.
+ **/
+
+#ifndef HEADER_LZ4CODEC
+#define HEADER_LZ4CODEC
+
+#ifdef USE_LZ4
+
+#include "Codec.hpp"
+
+/**
+ * @brief Declares Lz4Codec class.
+ */
+class Lz4Codec : public Codec
+{
+    public:
+        Lz4Codec(int level);
+
+        std::string name() override { return "lz4 acceleration " + std::to_string(acceleration); };
+        size_t maxCompressedSize(size_t length) override;
+        size_t compress(unsigned char *output, size_t capacity,
+                        const unsigned char *input, size_t length) override;
+        void decompress(unsigned char *output, size_t length,
+                        const unsigned char *input, size_t compressed_length) override;
+
+    private:
+        int acceleration;
+};
+#endif
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file MpiioBackend.hpp
+ * @brief This module declares the MPI-IO implementation of IOBackend
+ * @author Iole Bolognesi
+ *
+ * This module declares the MpiioBackend class, which writes and reads the
+ * cipher-text as a flat file of bytes, and the metadata as a flat binary
+ * file, through collective MPI-IO calls. Hints such as cb_nodes,
+ * cb_buffer_size, striping_factor and striping_unit are passed to every
+ * file opened.
+ **/
+
+#ifndef HEADER_MPIIOBACKEND
+#define HEADER_MPIIOBACKEND
+
+#include <mpi.h>
+
+#include "IOBackend.hpp"
+
+/**
+ * @brief Declares MpiioBackend class.
+ */
+class MpiioBackend : public IOBackend
+{
+    public:
+        MpiioBackend(const std::string hints);
+        ~MpiioBackend();
+        MpiioBackend(const MpiioBackend &) = delete;
+        MpiioBackend &operator=(const MpiioBackend &) = delete;
+
+        std::string name() override { return "MPI-IO"; };
+
+        void openMetadata(const std::string file_name, bool write) override;
+        void closeMetadata() override;
+        size_t metadataSteps() override { return 1; };
+        void openData(const std::string file_name, bool write) override;
+        void closeData() override;
+        size_t dataSteps() override { return 1; };
+
+        void writeMetadata(size_t nproc, size_t rank, size_t CT_local_size,
+                        size_t CT_global_offset, size_t CTmeta_global_size,
+                        size_t CTmeta_local_size, size_t CTmeta_global_offset,
+                        std::vector<size_t> &files_sizes,
+                        std::vector<size_t> &files_offsets,
+                        std::vector<size_t> &files_orig_sizes,
+                        std::vector<size_t> &files_compressed_sizes,
+                        const std::string &files_names, size_t names_global_size,
+                        size_t names_global_offset) override;
+        ParallelCTMeta readMetadata(size_t step, size_t nproc, size_t rank,
+                        size_t CTmeta_global_offset, size_t CTmeta_local_size) override;
+        void writeData(const std::vector<DataBlock> &blocks, size_t shape) override;
+        std::vector<uint8_t> readData(size_t step, size_t count, size_t start) override;
+
+        void streamWriteData(BoundedQueue<std::vector<uint8_t>> &full_buffers,
+                        BoundedQueue<std::vector<uint8_t>> &free_buffers,
+                        const std::string file_name, size_t shape, size_t count,
+                        size_t start, size_t n_rounds) override;
+        GlobalCTMeta readGlobalMetadata(const std::string file_name) override;
+        std::vector<std::vector<uint8_t>> readDataRanges(const std::string file_name,
+                        const std::vector<size_t> &starts,
+                        const std::vector<size_t> &counts) override;
+
+    private:
+        MPI_File openFile(const std::string file_name, bool write);
+        void closeFile(MPI_File &file, const std::string file_name);
+
+        MPI_Info info;
+        MPI_File metadata_file = MPI_FILE_NULL;
+        MPI_File data_file = MPI_FILE_NULL;
+        std::string metadata_file_name;
+        std::string data_file_name;
+};
+#endif
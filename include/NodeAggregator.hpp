@@ -0,0 +1,49 @@
+/**
+ * @file NodeAggregator.hpp
+ * @brief This module declares the aggregation of local cipher-texts on a node
+ * before they are written
+ * @author Iole Bolognesi
+ *
+ * This module declares the NodeAggregator class. The processes of a node are
+ * split into groups of a configurable number of processes, each group sharing
+ * a memory window in which every process stages its local cipher-text. The
+ * first process of each group, the aggregator, then writes the cipher-text of
+ * the whole group, so that the file system receives a few large writes per
+ * node instead of one small write per process.
+ **/
+
+#ifndef HEADER_NODEAGGREGATOR
+#define HEADER_NODEAGGREGATOR
+
+#include <mpi.h>
+#include <vector>
+
+#include "adios.hpp"
+
+/**
+ * @brief Declares NodeAggregator class.
+ */
+class NodeAggregator
+{
+    public:
+        NodeAggregator(size_t ranks_per_aggregator, size_t local_size, size_t global_offset);
+        ~NodeAggregator();
+        NodeAggregator(const NodeAggregator &) = delete;
+        NodeAggregator &operator=(const NodeAggregator &) = delete;
+
+        void aggregate(const unsigned char *data);
+        const std::vector<DataBlock> &blocks() const { return write_blocks; };
+        bool isAggregator() const { return group_rank == 0; };
+        size_t nAggregators() const { return n_aggregators; };
+
+    private:
+        MPI_Comm node_comm;
+        MPI_Comm group_comm;
+        MPI_Win window;
+        int group_rank;
+        unsigned char *segment;
+        size_t local_size;
+        size_t n_aggregators;
+        std::vector<DataBlock> write_blocks;
+};
+#endif
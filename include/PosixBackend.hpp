@@ -0,0 +1,80 @@
+/**
+ * @file PosixBackend.hpp
+ * @brief This module declares the file-per-process implementation of IOBackend
+ * @author Iole Bolognesi
+ *
+ * This module declares the PosixBackend class, which writes the cipher-text
+ * and the metadata of each process to a file of its own (N-N), within a
+ * directory named after the cipher-text or metadata file, with pwrite and
+ * optionally O_DIRECT. No file is shared between processes, which suits
+ * node-local storage such as NVMe burst buffers.
+ **/
+
+#ifndef HEADER_POSIXBACKEND
+#define HEADER_POSIXBACKEND
+
+#include <map>
+#include <memory>
+
+#include "IOBackend.hpp"
+#include "AlignedFile.hpp"
+
+/**
+ * @brief Declares PosixBackend class.
+ */
+class PosixBackend : public IOBackend
+{
+    public:
+        PosixBackend(bool direct);
+
+        std::string name() override { return direct ? "POSIX (O_DIRECT)" : "POSIX"; };
+
+        void openMetadata(const std::string file_name, bool write) override;
+        void closeMetadata() override;
+        size_t metadataSteps() override { return 1; };
+        void openData(const std::string file_name, bool write) override;
+        void closeData() override;
+        size_t dataSteps() override { return 1; };
+
+        void writeMetadata(size_t nproc, size_t rank, size_t CT_local_size,
+                        size_t CT_global_offset, size_t CTmeta_global_size,
+                        size_t CTmeta_local_size, size_t CTmeta_global_offset,
+                        std::vector<size_t> &files_sizes,
+                        std::vector<size_t> &files_offsets,
+                        std::vector<size_t> &files_orig_sizes,
+                        std::vector<size_t> &files_compressed_sizes,
+                        const std::string &files_names, size_t names_global_size,
+                        size_t names_global_offset) override;
+        ParallelCTMeta readMetadata(size_t step, size_t nproc, size_t rank,
+                        size_t CTmeta_global_offset, size_t CTmeta_local_size) override;
+        void writeData(const std::vector<DataBlock> &blocks, size_t shape) override;
+        std::vector<uint8_t> readData(size_t step, size_t count, size_t start) override;
+
+        void streamWriteData(BoundedQueue<std::vector<uint8_t>> &full_buffers,
+                        BoundedQueue<std::vector<uint8_t>> &free_buffers,
+                        const std::string file_name, size_t shape, size_t count,
+                        size_t start, size_t n_rounds) override;
+        GlobalCTMeta readGlobalMetadata(const std::string file_name) override;
+        std::vector<std::vector<uint8_t>> readDataRanges(const std::string file_name,
+                        const std::vector<size_t> &starts,
+                        const std::vector<size_t> &counts) override;
+
+    private:
+        void prepareDirectory(const std::filesystem::path directory);
+        void readRange(unsigned char *data, size_t count, size_t start);
+
+        bool direct;
+        size_t rank;
+        AlignedBufferPool pool;
+
+        std::filesystem::path metadata_directory;
+        std::unique_ptr<AlignedFile> metadata_file;
+
+        /* Cipher-text file of the calling process when writing; files of all
+        processes, opened on demand, and where each starts when reading */
+        std::filesystem::path data_directory;
+        std::unique_ptr<AlignedFile> data_file;
+        std::map<size_t, std::unique_ptr<AlignedFile>> data_readers;
+        std::vector<size_t> data_starts;
+};
+#endif
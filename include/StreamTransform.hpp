@@ -0,0 +1,119 @@
+/**
+ * @file StreamTransform.hpp
+ * @brief This module declares the StreamTransform interface through which
+ * buffers are encrypted and decrypted, and its Crypto++ implementation
+ * @author Iole Bolognesi
+ *
+ * This module declares the StreamTransform class, a type-erased encryption
+ * or decryption object, and the CryptoTransform template that implements it
+ * once for any Crypto++ mode object. Callers make one virtual call per
+ * buffer, or per batch of buffers through processMany, instead of
+ * instantiating their loops for every algorithm and mode.
+ **/
+
+#ifndef HEADER_STREAMTRANSFORM
+#define HEADER_STREAMTRANSFORM
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <secblock.h>
+
+/* A buffer to process and its position within the stream */
+struct TransformJob {
+    unsigned char *output;
+    const unsigned char *input;
+    size_t length;
+    size_t stream_offset;
+};
+
+/**
+ * @brief Declares StreamTransform abstract class.
+ */
+class StreamTransform
+{
+    public:
+        virtual ~StreamTransform() = default;
+
+        virtual std::string algorithmName() = 0;
+        virtual size_t blockSize() = 0;
+        virtual void process(unsigned char *output, const unsigned char *input,
+                            size_t length) = 0;
+        virtual void processMany(const TransformJob *jobs, size_t n_jobs, bool seeking) = 0;
+        virtual void seek(size_t stream_offset) = 0;
+        virtual void resynchronize(const unsigned char *iv, size_t length) = 0;
+        virtual std::unique_ptr<StreamTransform> clone() = 0;
+};
+
+/**
+ * @brief Declares CryptoTransform class, which wraps a Crypto++ encryption
+ * or decryption object keyed with a key and, unless it is empty, an IV.
+ */
+template <typename CryptoObject>
+class CryptoTransform : public StreamTransform
+{
+    public:
+        CryptoTransform(const CryptoPP::SecByteBlock &key, const CryptoPP::SecByteBlock &iv)
+            : key(key), iv(iv) {
+
+            if (iv.empty()) {
+                object.SetKey(key, key.size());
+            }
+            else {
+                object.SetKeyWithIV(key, key.size(), iv);
+            }
+        };
+
+        std::string algorithmName() override { return object.AlgorithmName(); };
+
+        size_t blockSize() override { return object.MandatoryBlockSize(); };
+
+        void process(unsigned char *output, const unsigned char *input,
+                    size_t length) override {
+            object.ProcessData(output, input, length);
+        };
+
+        /* Processes the jobs in turn, seeking to each one if requested,
+        otherwise carrying the state over from one job to the next */
+        void processMany(const TransformJob *jobs, size_t n_jobs, bool seeking) override {
+            for (size_t job = 0; job < n_jobs; job++) {
+                if (seeking) {
+                    object.Seek(jobs[job].stream_offset);
+                }
+                object.ProcessData(jobs[job].output, jobs[job].input, jobs[job].length);
+            }
+        };
+
+        void seek(size_t stream_offset) override { object.Seek(stream_offset); };
+
+        /* Only the first IVSize() bytes of a longer IV are used, as by 
+        SetKeyWithIV (ChaCha20 takes 8 bytes) */
+        void resynchronize(const unsigned char *iv, size_t length) override {
+            object.Resynchronize(iv, static_cast<int>(std::min<size_t>(length, object.IVSize())));
+        };
+
+        /* The copy is keyed anew, so it starts at the beginning of the stream */
+        std::unique_ptr<StreamTransform> clone() override {
+            return std::make_unique<CryptoTransform<CryptoObject>>(key, iv);
+        };
+
+    private:
+        CryptoObject object;
+        CryptoPP::SecByteBlock key;
+        CryptoPP::SecByteBlock iv;
+};
+
+/**
+ * @brief Creates a StreamTransform around a new Crypto++ object.
+ *
+ * @param key  Key of the object.
+ * @param iv   IV of the object, empty for modes without one (ECB).
+ * @return The keyed transform.
+ */
+template <typename CryptoObject>
+std::unique_ptr<StreamTransform> makeTransform(
+                                const CryptoPP::SecByteBlock &key,
+                                const CryptoPP::SecByteBlock &iv = CryptoPP::SecByteBlock()){
+    return std::make_unique<CryptoTransform<CryptoObject>>(key, iv);
+}
+#endif
@@ -0,0 +1,67 @@
+/**
+ * @file ThreadPool.hpp
+ * @brief This module declares a fixed-size thread pool used inside each rank
+ * @author Iole Bolognesi
+ *
+ * This module declares the ThreadPool class, which keeps a set of worker
+ * threads alive for the whole run and distributes the iterations of a
+ * parallel loop across them by work stealing. No worker thread performs MPI
+ * calls, so the pool only requires MPI_THREAD_FUNNELED.
+ **/
+
+#ifndef HEADER_THREADPOOL
+#define HEADER_THREADPOOL
+
+#include <memory>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Declares ThreadPool class.
+ */
+class ThreadPool
+{
+    public:
+        /* Loop body, called with the task index and the id of the worker running it */
+        using Task = std::function<void(size_t task_index, unsigned int worker_id)>;
+
+        ThreadPool(unsigned int n_threads = 1);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        unsigned int size() const { return n_workers; };
+        void parallelFor(size_t n_tasks, const Task &task);
+
+    private:
+        /* Range of loop iterations still owned by a worker */
+        struct WorkRange {
+            std::mutex mutex;
+            size_t front = 0;
+            size_t back = 0;
+        };
+
+        void workerLoop(unsigned int worker_id);
+        void runTasks(unsigned int worker_id);
+        bool takeTask(unsigned int worker_id, size_t &task_index);
+        bool stealTasks(unsigned int worker_id);
+
+        unsigned int n_workers;
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable wake_workers;
+        std::condition_variable job_done;
+        bool stopping = false;
+        size_t generation = 0;
+        unsigned int busy_workers = 0;
+
+        const Task *current_task = nullptr;
+        std::unique_ptr<WorkRange[]> ranges;
+        std::exception_ptr error;
+};
+#endif
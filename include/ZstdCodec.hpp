@@ -0,0 +1,36 @@
+/**
+ * @file ZstdCodec.hpp
+ * @brief This module declares the Zstandard implementation of Codec
+ * @author Iole Bolognesi
+ *
+ * This module declares the ZstdCodec class, available when built with
+ * USE_ZSTD. Each file is compressed as a single Zstandard frame.
+ **/
+
+#ifndef HEADER_ZSTDCODEC
+#define HEADER_ZSTDCODEC
+
+#ifdef USE_ZSTD
+
+#include "Codec.hpp"
+
+/**
+ * @brief Declares ZstdCodec class.
+ */
+class ZstdCodec : public Codec
+{
+    public:
+        ZstdCodec(int level);
+
+        std::string name() override { return "zstd level " + std::to_string(level); };
+        size_t maxCompressedSize(size_t length) override;
+        size_t compress(unsigned char *output, size_t capacity,
+                        const unsigned char *input, size_t length) override;
+        void decompress(unsigned char *output, size_t length,
+                        const unsigned char *input, size_t compressed_length) override;
+
+    private:
+        int level;
+};
+#endif
+#endif
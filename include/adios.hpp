@@ -5,7 +5,8 @@
  * @author Iole Bolognesi
  *
  * This module declares functions to read and write metadata as well as cipher data
- (raw byte buffers) through ADIOS2. 
+ (raw byte buffers) through ADIOS2, either as a whole file or as one step of
+ an engine kept open across iterations. 
  */
 #ifndef INCLUDE_ADIOS_HEADER
 #define INCLUDE_ADIOS_HEADER
@@ -13,6 +14,25 @@
 #include <adios2.h>
 #include <string>
 #include "libpar.hpp"
+#include "BoundedQueue.hpp"
+
+/* Block of the global cipher-text put by the calling process */
+struct DataBlock {
+    const uint8_t *data;
+    size_t start;
+    size_t count;
+};
+
+/* IO and engine kept open across iterations, each one a step */
+struct AdiosStream {
+    adios2::IO io;
+    adios2::Engine engine;
+};
+
+adios2::IO declareOrAtIO(adios2::ADIOS &adios, const std::string io_name);
+
+AdiosStream openStream(adios2::ADIOS &adios, const std::string io_name,
+                    const std::string file_name, adios2::Mode mode);
 
 void parallelWriteMetadata(adios2::ADIOS &adios, size_t nproc, size_t rank,
                         size_t count, size_t CT_local_size, 
@@ -21,17 +41,61 @@ void parallelWriteMetadata(adios2::ADIOS &adios, size_t nproc, size_t rank,
                         size_t CTmeta_local_size, size_t CTmeta_global_offset, 
                         std::vector<size_t> &files_sizes,
                         std::vector<size_t> &files_offsets,
-                        const std::string file_name, std::string iter_id);
+                        std::vector<size_t> &files_orig_sizes,
+                        std::vector<size_t> &files_compressed_sizes,
+                        const std::string &files_names, size_t names_global_size,
+                        size_t names_global_offset, const std::string file_name);
+
+void writeMetadataStep(AdiosStream &stream, size_t nproc, size_t rank,
+                        size_t count, size_t CT_local_size, 
+                        size_t CT_global_offset,
+                        size_t CTmeta_global_size, 
+                        size_t CTmeta_local_size, size_t CTmeta_global_offset, 
+                        std::vector<size_t> &files_sizes,
+                        std::vector<size_t> &files_offsets,
+                        std::vector<size_t> &files_orig_sizes,
+                        std::vector<size_t> &files_compressed_sizes,
+                        const std::string &files_names, size_t names_global_size,
+                        size_t names_global_offset);
 
 ParallelCTMeta parallelReadMetadata(adios2::ADIOS &adios, const std::string file_name,
                                 size_t nproc, size_t rank, size_t count,
                                 size_t CTmeta_global_offset, 
-                                size_t CTmeta_local_size, std::string iter_id);
+                                size_t CTmeta_local_size);
 
-void parallelWriteData(adios2::ADIOS &adios, std::vector<uint8_t> &data, 
+ParallelCTMeta readMetadataStep(AdiosStream &stream, size_t step,
+                                size_t nproc, size_t rank, size_t count,
+                                size_t CTmeta_global_offset, 
+                                size_t CTmeta_local_size);
+
+GlobalCTMeta readGlobalMetadata(adios2::ADIOS &adios, const std::string file_name);
+
+void parallelWriteData(adios2::ADIOS &adios, const uint8_t *data, 
                   const std::string file_name, size_t shape, size_t count, 
-                  size_t start, std::string iter_id);
+                  size_t start);
+
+void writeDataStep(AdiosStream &stream, const uint8_t *data, 
+                  size_t shape, size_t count, size_t start);
+
+void parallelWriteDataBlocks(adios2::ADIOS &adios, const std::vector<DataBlock> &blocks,
+                  const std::string file_name, size_t shape);
+
+void writeDataBlocksStep(AdiosStream &stream, const std::vector<DataBlock> &blocks,
+                  size_t shape);
+
+void parallelStreamWriteData(adios2::ADIOS &adios, 
+                  BoundedQueue<std::vector<uint8_t>> &full_buffers,
+                  BoundedQueue<std::vector<uint8_t>> &free_buffers,
+                  const std::string file_name, size_t shape, size_t count, 
+                  size_t start, size_t n_rounds);
 
 std::vector<uint8_t> parallelReadData(adios2::ADIOS &adios, const std::string file_name,
-                                    size_t count, size_t start, std::string iter_id);
-#endif 
\ No newline at end of file
+                                    size_t count, size_t start);
+
+std::vector<uint8_t> readDataStep(AdiosStream &stream, size_t step, size_t count, size_t start);
+
+std::vector<std::vector<uint8_t>> parallelReadDataRanges(adios2::ADIOS &adios, 
+                                    const std::string file_name,
+                                    const std::vector<size_t> &starts,
+                                    const std::vector<size_t> &counts);
+#endif 
@@ -21,16 +21,37 @@ struct ParallelCTMeta {
     size_t global_offset;
     std::vector<size_t> files_sizes;
     std::vector<size_t> files_offsets;
+    std::vector<size_t> files_orig_sizes;
+    std::vector<size_t> files_compressed_sizes;
+    std::vector<std::string> files_names;
 };
 
-adios2::ADIOS initParallelContext(int &argc, char ** &argv, int &rank, int &size);
+/* Structure of the metadata of the whole cipher-text, as written by all processes */
+struct GlobalCTMeta {
+    std::vector<size_t> local_sizes;
+    std::vector<size_t> global_offsets;
+    std::vector<size_t> local_counts;
+    std::vector<size_t> files_sizes;
+    std::vector<size_t> files_offsets;
+    std::vector<size_t> files_orig_sizes;
+    std::vector<size_t> files_compressed_sizes;
+    std::vector<std::string> files_names;
+};
+
+void initParallelContext(int &argc, char ** &argv, int &rank, int &size);
+adios2::ADIOS createAdios(const std::string config_file);
 void reduce_and_broadcast(const void *send_buffer, void *recv_buffer, int count,
                   MPI_Datatype datatype, MPI_Op operation, MPI_Comm comm);
 void exclusive_scan(const void *send_buffer, void *recv_buffer, int count,
                   MPI_Datatype datatype, MPI_Op operation, MPI_Comm comm);
+void broadcast(void *buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm);
+void gather(const void *send_buffer, void *recv_buffer, int count, MPI_Datatype datatype,
+            int root, MPI_Comm comm);
 void waitForProcesses(void);
 double getTime(void);
 void exitParallelContext(void);
 void endParallelContext(void);
 void decompose1D(size_t global_size, size_t &offset, size_t &local_size, int nproc, int rank);
+void decomposeBySize(const std::vector<size_t> &files_sizes, std::vector<size_t> &counts,
+                    std::vector<size_t> &displacements, int nproc);
 #endif 
\ No newline at end of file
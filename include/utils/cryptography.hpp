@@ -10,9 +10,19 @@
 #define HEADER_CRYPTOGRAPHY
 
 #include <vector>
+#include <cstddef>
 
 void addPadding(std::vector<unsigned char> &input, int block_size);
 
+size_t paddedSize(size_t input_size, int block_size);
+
+size_t addPaddingInPlace(unsigned char *buffer, size_t input_size, int block_size);
+
+size_t copyPaddedTail(unsigned char *tail, const unsigned char *input, 
+                    size_t input_size, int block_size);
+
 void removePadding(std::vector<unsigned char> &input);
 
+size_t unpaddedSize(const unsigned char *input, size_t input_size);
+
 #endif 
\ No newline at end of file
@@ -4,13 +4,18 @@
  * @author Iole Bolognesi
  *
  * This module declares the CTMeta struct and functions to write and read binary
- * files as well as metadata files, and configure working directories.
+ * files as well as metadata files, and configure working directories. It also
+ * declares the MappedFile class, a read-only memory-mapped view of a file, 
+ * and the MetadataTable class, a view of a binary metadata file.
  */
 #ifndef HEADER_FILEIO
 #define HEADER_FILEIO
 
 #include <vector>
+#include <memory>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
@@ -20,11 +25,90 @@ struct CTMeta {
     std::string file_name;
     size_t size;
     size_t offset;
+    size_t orig_size;
+    size_t compressed_size;
     friend std::istream& operator>>(std::istream& input, CTMeta& metadata);
 };
+
+/* Allocator that leaves elements uninitialised when a vector is resized, 
+for buffers that are entirely overwritten before being read */
+template <typename T>
+struct UninitializedAllocator : std::allocator<T> {
+    template <typename U> struct rebind { using other = UninitializedAllocator<U>; };
+
+    UninitializedAllocator() = default;
+    template <typename U> UninitializedAllocator(const UninitializedAllocator<U> &) {};
+
+    template <typename U> void construct(U *pointer) { ::new (static_cast<void*>(pointer)) U; };
+    template <typename U, typename... Args> void construct(U *pointer, Args&&... args) {
+        ::new (static_cast<void*>(pointer)) U(std::forward<Args>(args)...);
+    };
+};
+
+/* Byte buffer whose resize does not zero the new bytes */
+using ByteBuffer = std::vector<unsigned char, UninitializedAllocator<unsigned char>>;
+
+/* Read-only memory-mapped view of a file */
+class MappedFile {
+    public:
+        MappedFile(const std::filesystem::path file_name);
+        ~MappedFile();
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const unsigned char *data() const { return address; };
+        size_t size() const { return length; };
+
+    private:
+        const unsigned char *address = nullptr;
+        size_t length = 0;
+};
+
+/* Header of a binary metadata file, followed by n_records MetadataRecord
+objects and by a table of names_size bytes of NUL-terminated file names */
+struct MetadataHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t n_records;
+    uint64_t names_size;
+};
+
+/* Fixed-width record of a binary metadata file */
+struct MetadataRecord {
+    uint64_t name_offset;
+    uint64_t size;
+    uint64_t offset;
+    uint64_t orig_size;
+    uint64_t compressed_size;
+};
+
+/* Read-only view of a binary metadata file, with constant-time access by index */
+class MetadataTable {
+    public:
+        MetadataTable(const std::filesystem::path file_name);
+
+        size_t size() const { return n_records; };
+        const MetadataRecord &record(size_t index) const { return records[index]; };
+        std::string_view fileName(size_t index) const;
+        CTMeta operator[](size_t index) const;
+
+    private:
+        MappedFile file;
+        const MetadataRecord *records = nullptr;
+        const char *names = nullptr;
+        size_t n_records = 0;
+        size_t names_size = 0;
+};
+
 std::vector<CTMeta> loadMetadataFile(const std::filesystem::path file_name);
 std::vector<unsigned char> loadFile(const std::filesystem::path file_name);
+void loadFileInto(const std::filesystem::path file_name, unsigned char *buffer, size_t length);
 void saveMetadataFile(const std::filesystem::path file_name, const std::vector<CTMeta> &metadata);
+void saveBinaryMetadataFile(const std::filesystem::path file_name, const std::vector<CTMeta> &metadata);
 void saveFile(const std::filesystem::path file_name, const std::vector<unsigned char> &data);
+void saveFile(const std::filesystem::path file_name, const unsigned char *data, size_t length);
 void setDirectory(const std::filesystem::path directory_name);
 #endif
\ No newline at end of file
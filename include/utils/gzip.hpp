@@ -0,0 +1,23 @@
+/**
+ * @file gzip.hpp
+ * @brief This module declares functions to decompress gzip files
+ * @author Iole Bolognesi
+ *
+ * This module declares functions to recognise gzip files and to decompress
+ * them into memory through zlib, so that the dataset files are encrypted
+ * as their raw contents. Decompression requires building with USE_ZLIB.
+ */
+#ifndef HEADER_GZIP
+#define HEADER_GZIP
+
+#include <filesystem>
+#include <string>
+
+#include "fileIO.hpp"
+
+bool isGzipFile(const std::filesystem::path &file_name);
+std::filesystem::path gunzippedName(const std::filesystem::path &file_name);
+ByteBuffer gunzip(const unsigned char *input, size_t length, const std::string &source);
+ByteBuffer gunzipFile(const std::filesystem::path &file_name, size_t file_size, bool mapped);
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file keyFile.hpp
+ * @brief This module declares functions to save and load the keys of the
+ * parallel pipeline
+ * @author Iole Bolognesi
+ *
+ * This module declares the layout of a key file, which holds the key and IV
+ * that each process used to encrypt its local cipher-text, and the functions
+ * to write and read it. Key files are readable by their owner only, and
+ * their records are wrapped with AES-GCM under a key derived from a
+ * passphrase with PBKDF2-HMAC-SHA256 if one is given.
+ */
+#ifndef HEADER_KEYFILE
+#define HEADER_KEYFILE
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <secblock.h>
+
+/* Iterations of PBKDF2 deriving the key wrapping the records */
+#define KEY_FILE_KDF_ITERATIONS 600000
+
+/* Header of a key file, followed by n_keys records of key_size bytes of key
+and iv_size bytes of IV, one per process in rank order */
+struct KeyFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t n_keys;
+    uint32_t key_size;
+    uint32_t iv_size;
+};
+
+/* Follows the header of a protected key file (version 2), whose records 
+are encrypted and followed by a tag of 16 bytes. Both headers are 
+authenticated with the records */
+struct KeyWrapHeader {
+    uint32_t kdf_iterations;
+    unsigned char salt[16];
+    unsigned char nonce[12];
+};
+
+/* Key and IV of the cipher-text of one process */
+struct ProcessKey {
+    CryptoPP::SecByteBlock key;
+    CryptoPP::SecByteBlock iv;
+};
+
+void saveKeyFile(const std::filesystem::path file_name, const CryptoPP::SecByteBlock &records,
+                size_t n_keys, size_t key_size, size_t iv_size, 
+                const std::string &passphrase = "");
+std::vector<ProcessKey> loadKeyFile(const std::filesystem::path file_name, 
+                                    const std::string &passphrase = "");
+std::string loadPassphrase(const std::filesystem::path file_name);
+
+#endif
@@ -1,11 +1,12 @@
 /**
  * @file Parsing.hpp
  * @brief This module declares parsing utilities to convert a string 
- * to a CiperType enum
+ * to a CipherType and to read the command-line options
  * @author Iole Bolognesi
  *
  * This module declares a function that maps a cipher name to the
- * corresponding CipherType enum. 
+ * corresponding CipherType, and the PipelineOptions and ExtractOptions 
+ * structs with the functions that fill them from the command line. 
  */
 #ifndef HEADER_PARSING
 #define HEADER_PARSING
@@ -13,9 +14,83 @@
 #include <optional>       
 #include <string_view>    
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "CipherFactory.hpp"
+#include "CryptoStage.hpp"
+#include "AsyncFileWriter.hpp"
+#include "BatchedReader.hpp"
+#include "IOBackendFactory.hpp"
+#include "CodecFactory.hpp"
 
-CipherType getEnumFromString(std::string_view input, int rank);
+/* Strategies to split the dataset files across processes */
+enum PartitionType {
+    PARTITION_FILES, PARTITION_BYTES
+};
+
+/* Ways of reading the dataset files */
+enum InputType {
+    INPUT_READ, INPUT_MMAP, INPUT_URING
+};
+
+/* Formats of the metadata file of the serial pipeline */
+enum MetadataType {
+    METADATA_BINARY, METADATA_TEXT
+};
+
+/* Ways of repeating the ADIOS 2 writes and reads of the parallel pipeline */
+enum IOModeType {
+    IO_REOPEN, IO_PERSISTENT
+};
+
+/* Structure of the command-line options of the serial and parallel pipelines */
+struct PipelineOptions {
+    std::string dataset_directory;
+    std::string cipher_name;
+    unsigned int n_threads = 1;
+    ThreadingType threading = THREADS_CHUNKS;
+    size_t chunk_bytes = DEFAULT_CHUNK_BYTES;
+    PartitionType partition = PARTITION_FILES;
+    size_t stream_bytes = 0;
+    InputType input = INPUT_READ;
+    unsigned int read_depth = DEFAULT_READ_DEPTH;
+    unsigned int n_writers = 0;
+    size_t queue_depth = DEFAULT_WRITE_QUEUE_DEPTH;
+    MetadataType metadata_format = METADATA_BINARY;
+    std::string key_file;
+    std::string passphrase_file;
+    IOModeType io_mode = IO_REOPEN;
+    std::string adios_config;
+    size_t ranks_per_aggregator = 0;
+    IOBackendType io_backend = BACKEND_ADIOS;
+    std::string mpiio_hints;
+    bool direct_io = false;
+    CodecType codec = CODEC_NONE;
+    int compression_level = 0;
+    bool gunzip = false;
+};
+
+/* Structure of the command-line options of the extraction tool */
+struct ExtractOptions {
+    std::string cipher_name;
+    std::string key_file;
+    std::string passphrase_file;
+    std::vector<std::string> patterns;
+    std::string data_file = "output/encryptedData";
+    std::string metadata_file = "output/metadata";
+    std::string output_directory = "output/extractedData";
+    std::string adios_config;
+    IOBackendType io_backend = BACKEND_ADIOS;
+    std::string mpiio_hints;
+    bool direct_io = false;
+    CodecType codec = CODEC_NONE;
+};
+
+CipherType getCipherType(std::string_view input, int rank);
+std::optional<PipelineOptions> parseOptions(int argc, char *argv[]);
+void printOptionsUsage(void);
+std::optional<ExtractOptions> parseExtractOptions(int argc, char *argv[]);
+void printExtractUsage(void);
 
 #endif
\ No newline at end of file
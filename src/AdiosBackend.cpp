@@ -0,0 +1,168 @@
+/**
+* @file AdiosBackend.cpp
+* @brief This module provides the implementation of the AdiosBackend class.
+* @author Iole Bolognesi
+*
+* Each open file is an ADIOS 2 engine, with IO objects of fixed names:
+* MetadataWriter and DataWriter to write, MetadataReader and DataReader to
+* read, which can be configured through an ADIOS 2 config file. Files are
+* read in random-access mode, so that any step can be read.
+*/
+
+#include "AdiosBackend.hpp"
+
+#include <algorithm>
+
+/**
+ * @brief Opens the metadata file.
+ *
+ * @param file_name  Name of the ADIOS2 file.
+ * @param write      Whether to open it for writing, or else for reading.
+ */
+void AdiosBackend::openMetadata(const std::string file_name, bool write){
+
+    if (write) {
+        metadata_stream = openStream(adios, "MetadataWriter", file_name, adios2::Mode::Write);
+    }
+    else {
+        metadata_stream = openStream(adios, "MetadataReader", file_name,
+                                    adios2::Mode::ReadRandomAccess);
+    }
+}
+
+/**
+ * @brief Closes the metadata file.
+ */
+void AdiosBackend::closeMetadata(){
+
+    metadata_stream->engine.Close();
+    metadata_stream.reset();
+}
+
+/**
+ * @brief Returns the number of steps of the metadata file open for reading.
+ *
+ * @return The number of steps, at least 1.
+ */
+size_t AdiosBackend::metadataSteps(){
+
+    return std::max<size_t>(metadata_stream->engine.Steps(), 1);
+}
+
+/**
+ * @brief Opens the cipher-text file.
+ *
+ * @param file_name  Name of the ADIOS2 file.
+ * @param write      Whether to open it for writing, or else for reading.
+ */
+void AdiosBackend::openData(const std::string file_name, bool write){
+
+    if (write) {
+        data_stream = openStream(adios, "DataWriter", file_name, adios2::Mode::Write);
+    }
+    else {
+        data_stream = openStream(adios, "DataReader", file_name,
+                                adios2::Mode::ReadRandomAccess);
+    }
+}
+
+/**
+ * @brief Closes the cipher-text file.
+ */
+void AdiosBackend::closeData(){
+
+    data_stream->engine.Close();
+    data_stream.reset();
+}
+
+/**
+ * @brief Returns the number of steps of the cipher-text file open for reading.
+ *
+ * @return The number of steps, at least 1.
+ */
+size_t AdiosBackend::dataSteps(){
+
+    return std::max<size_t>(data_stream->engine.Steps(), 1);
+}
+
+/**
+ * @brief Writes the encryption metadata as one step of the metadata file.
+ * Parameters are as for writeMetadataStep, with one entry per process.
+ */
+void AdiosBackend::writeMetadata(size_t nproc, size_t rank, size_t CT_local_size,
+                                size_t CT_global_offset, size_t CTmeta_global_size,
+                                size_t CTmeta_local_size, size_t CTmeta_global_offset,
+                                std::vector<size_t> &files_sizes,
+                                std::vector<size_t> &files_offsets,
+                                std::vector<size_t> &files_orig_sizes,
+                                std::vector<size_t> &files_compressed_sizes,
+                                const std::string &files_names, size_t names_global_size,
+                                size_t names_global_offset){
+
+    writeMetadataStep(*metadata_stream, nproc, rank, 1, CT_local_size, CT_global_offset,
+                    CTmeta_global_size, CTmeta_local_size, CTmeta_global_offset,
+                    files_sizes, files_offsets, files_orig_sizes, files_compressed_sizes,
+                    files_names, names_global_size, names_global_offset);
+}
+
+/**
+ * @brief Reads the encryption metadata of the calling process from one step
+ * of the metadata file. Parameters are as for readMetadataStep.
+ */
+ParallelCTMeta AdiosBackend::readMetadata(size_t step, size_t nproc, size_t rank,
+                                        size_t CTmeta_global_offset, size_t CTmeta_local_size){
+
+    return readMetadataStep(*metadata_stream, step, nproc, rank, 1,
+                            CTmeta_global_offset, CTmeta_local_size);
+}
+
+/**
+ * @brief Writes blocks of the cipher-text as one step of the cipher-text file.
+ * Parameters are as for writeDataBlocksStep.
+ */
+void AdiosBackend::writeData(const std::vector<DataBlock> &blocks, size_t shape){
+
+    writeDataBlocksStep(*data_stream, blocks, shape);
+}
+
+/**
+ * @brief Reads the local cipher-text from one step of the cipher-text file.
+ * Parameters are as for readDataStep.
+ */
+std::vector<uint8_t> AdiosBackend::readData(size_t step, size_t count, size_t start){
+
+    return readDataStep(*data_stream, step, count, start);
+}
+
+/**
+ * @brief Writes the cipher-text one buffer at a time, as it is encrypted.
+ * Parameters are as for parallelStreamWriteData.
+ */
+void AdiosBackend::streamWriteData(BoundedQueue<std::vector<uint8_t>> &full_buffers,
+                                BoundedQueue<std::vector<uint8_t>> &free_buffers,
+                                const std::string file_name, size_t shape, size_t count,
+                                size_t start, size_t n_rounds){
+
+    parallelStreamWriteData(adios, full_buffers, free_buffers, file_name, shape, count,
+                            start, n_rounds);
+}
+
+/**
+ * @brief Reads the metadata of all processes. Parameters are as for
+ * ::readGlobalMetadata.
+ */
+GlobalCTMeta AdiosBackend::readGlobalMetadata(const std::string file_name){
+
+    return ::readGlobalMetadata(adios, file_name);
+}
+
+/**
+ * @brief Reads ranges of the cipher-text. Parameters are as for
+ * parallelReadDataRanges.
+ */
+std::vector<std::vector<uint8_t>> AdiosBackend::readDataRanges(const std::string file_name,
+                                                const std::vector<size_t> &starts,
+                                                const std::vector<size_t> &counts){
+
+    return parallelReadDataRanges(adios, file_name, starts, counts);
+}
@@ -0,0 +1,340 @@
+/**
+* @file AlignedFile.cpp
+* @brief This module provides the implementation of the AlignedBufferPool
+* and AlignedFile classes.
+* @author Iole Bolognesi
+*
+* Without O_DIRECT, appended bytes are written straight from the caller's
+* memory. With O_DIRECT, they are copied into a buffer of the pool, which is
+* written whenever full; the last, partial buffer is padded to the alignment
+* and the file is then truncated to its exact size. Reads are widened to
+* aligned boundaries and copied out of a pool buffer.
+*
+* Space for a whole file is reserved with fallocate before it is written,
+* where the file system supports it. File systems that refuse O_DIRECT, such
+* as tmpfs, are written through the page cache instead.
+*/
+
+#include "AlignedFile.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Rounds a size up to a multiple of DIRECT_IO_ALIGNMENT.
+ */
+static size_t alignUp(size_t size){
+
+    return (size + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+}
+
+/**
+ * @brief Constructs an empty pool of aligned buffers.
+ *
+ * @param buffer_bytes  Size of each buffer, rounded up to DIRECT_IO_ALIGNMENT.
+ */
+AlignedBufferPool::AlignedBufferPool(size_t buffer_bytes)
+    : buffer_bytes(alignUp(std::max<size_t>(buffer_bytes, 1))) {}
+
+/**
+ * @brief Returns a buffer, reusing one given back if there is one.
+ *
+ * @return A page-aligned buffer of bufferSize() bytes.
+ *
+ * @throws std::bad_alloc if a new buffer cannot be allocated.
+ */
+AlignedBufferPool::Buffer AlignedBufferPool::take(){
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!free_buffers.empty()) {
+            Buffer buffer = std::move(free_buffers.back());
+            free_buffers.pop_back();
+            return buffer;
+        }
+    }
+
+    void *memory = std::aligned_alloc(DIRECT_IO_ALIGNMENT, buffer_bytes);
+
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return Buffer(static_cast<unsigned char*>(memory));
+}
+
+/**
+ * @brief Gives a buffer back to the pool.
+ *
+ * @param buffer  Buffer obtained from take.
+ */
+void AlignedBufferPool::give(Buffer buffer){
+
+    std::lock_guard<std::mutex> lock(mutex);
+    free_buffers.push_back(std::move(buffer));
+}
+
+/**
+ * @brief Opens a file, creating or emptying it if opened for writing.
+ *
+ * @param file_name  Path to the file.
+ * @param write      Whether to open it for writing, or else for reading.
+ * @param direct     Whether to bypass the page cache with O_DIRECT, where
+ *                   the file system allows it.
+ * @param pool       Pool providing the aligned buffers.
+ *
+ * @throws std::runtime_error if the file cannot be opened.
+ */
+AlignedFile::AlignedFile(const std::filesystem::path file_name, bool write, bool direct,
+                        AlignedBufferPool &pool)
+    : file_name(file_name), direct(direct), pool(pool) {
+
+    int flags = write ? O_WRONLY | O_CREAT | O_TRUNC : O_RDONLY;
+
+    file_descriptor = open(file_name.c_str(), flags | (direct ? O_DIRECT : 0), 0644);
+
+    if (file_descriptor < 0 && direct && errno == EINVAL) {
+        this->direct = false;
+        file_descriptor = open(file_name.c_str(), flags, 0644);
+    }
+
+    if (file_descriptor < 0) {
+        throw std::runtime_error("Failed to open file for " +
+                                std::string(write ? "writing: " : "reading: ") +
+                                file_name.string() + " (" + std::strerror(errno) + ")");
+    }
+}
+
+/**
+ * @brief Closes the file. Bytes appended since the last finish are lost.
+ */
+AlignedFile::~AlignedFile(){
+
+    if (buffer) {
+        pool.give(std::move(buffer));
+    }
+    close(file_descriptor);
+}
+
+/**
+ * @brief Reserves space for the contents of the file up front, so that it 
+ * is allocated in large extents. Ignored where fallocate is not supported.
+ *
+ * @param length  Size of the contents.
+ *
+ * @throws std::runtime_error if the space cannot be reserved.
+ */
+void AlignedFile::reserve(size_t length){
+
+    if (length > 0 && fallocate(file_descriptor, 0, 0, length) != 0 &&
+        errno != EOPNOTSUPP && errno != ENOSYS) {
+        throw std::runtime_error("Failed to allocate file: " + file_name.string() +
+                                " (" + std::strerror(errno) + ")");
+    }
+}
+
+/**
+ * @brief Writes the whole contents of the file, replacing previous contents.
+ *
+ * @param data    Pointer to the contents.
+ * @param length  Size of the contents.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void AlignedFile::writeContents(const unsigned char *data, size_t length){
+
+    reserve(length);
+    append(data, length);
+    finish();
+}
+
+/**
+ * @brief Writes bytes after those appended since the last finish, starting
+ * from the beginning of the file.
+ *
+ * @param data    Pointer to the bytes.
+ * @param length  Number of bytes.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void AlignedFile::append(const unsigned char *data, size_t length){
+
+    if (!direct) {
+        while (length > 0) {
+            ssize_t result = pwrite(file_descriptor, data, length, written);
+
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result < 0) {
+                throw std::runtime_error("Failed to write file: " + file_name.string() +
+                                        " (" + std::strerror(errno) + ")");
+            }
+            data += result;
+            length -= result;
+            written += result;
+        }
+        return;
+    }
+
+    while (length > 0) {
+
+        if (!buffer) {
+            buffer = pool.take();
+        }
+
+        size_t piece = std::min(length, pool.bufferSize() - filled);
+        std::memcpy(buffer.get() + filled, data, piece);
+
+        filled += piece;
+        data += piece;
+        length -= piece;
+
+        if (filled == pool.bufferSize()) {
+            flushBuffer(filled);
+        }
+    }
+}
+
+/**
+ * @brief Writes the bytes still buffered and truncates the file to the
+ * bytes appended, so that the next append starts a new contents.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void AlignedFile::finish(){
+
+    size_t length = written + filled;
+
+    if (filled > 0) {
+        /* The tail is padded to the alignment, then cut by the truncation */
+        size_t padded = alignUp(filled);
+        std::memset(buffer.get() + filled, 0, padded - filled);
+        flushBuffer(padded);
+    }
+
+    if (buffer) {
+        pool.give(std::move(buffer));
+    }
+
+    if (ftruncate(file_descriptor, length) != 0) {
+        throw std::runtime_error("Failed to truncate file: " + file_name.string() +
+                                " (" + std::strerror(errno) + ")");
+    }
+
+    written = 0;
+}
+
+/**
+ * @brief Writes the aligned buffer at the current aligned file offset.
+ *
+ * @param length  Number of bytes of the buffer to write, a multiple of
+ *                DIRECT_IO_ALIGNMENT.
+ *
+ * @throws std::runtime_error if the buffer cannot be written.
+ */
+void AlignedFile::flushBuffer(size_t length){
+
+    size_t position = 0;
+
+    while (position < length) {
+        ssize_t result = pwrite(file_descriptor, buffer.get() + position, length - position,
+                                written + position);
+
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            throw std::runtime_error("Failed to write file: " + file_name.string() +
+                                    " (" + std::strerror(errno) + ")");
+        }
+        position += result;
+    }
+
+    written += std::min(length, filled);
+    filled = 0;
+}
+
+/**
+ * @brief Reads bytes of the file.
+ *
+ * @param data    Pointer to a buffer of at least length bytes.
+ * @param length  Number of bytes to read.
+ * @param offset  Offset of the first byte within the file.
+ *
+ * @throws std::runtime_error if the file cannot be read or ends before
+ *         offset + length.
+ */
+void AlignedFile::read(unsigned char *data, size_t length, size_t offset){
+
+    if (!direct) {
+        while (length > 0) {
+            ssize_t result = pread(file_descriptor, data, length, offset);
+
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result <= 0) {
+                throw std::runtime_error("Failed to read file: " + file_name.string());
+            }
+            data += result;
+            length -= result;
+            offset += result;
+        }
+        return;
+    }
+
+    AlignedBufferPool::Buffer read_buffer = pool.take();
+    size_t end = offset + length;
+
+    try {
+        while (offset < end) {
+            /* A short read may end mid-block, so each pass restarts at the 
+            aligned block holding the next byte */
+            size_t chunk_start = offset - offset % DIRECT_IO_ALIGNMENT;
+            ssize_t result = pread(file_descriptor, read_buffer.get(),
+                                std::min(pool.bufferSize(), alignUp(end - chunk_start)),
+                                chunk_start);
+
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result <= 0 || chunk_start + result <= offset) {
+                throw std::runtime_error("Failed to read file: " + file_name.string());
+            }
+
+            size_t copy_end = std::min(end, chunk_start + result);
+            std::memcpy(data, read_buffer.get() + (offset - chunk_start), copy_end - offset);
+
+            data += copy_end - offset;
+            offset = copy_end;
+        }
+    }
+    catch (...) {
+        pool.give(std::move(read_buffer));
+        throw;
+    }
+
+    pool.give(std::move(read_buffer));
+}
+
+/**
+ * @brief Returns the size of the file.
+ *
+ * @throws std::runtime_error if the size cannot be read.
+ */
+size_t AlignedFile::size(){
+
+    struct stat file_status;
+
+    if (fstat(file_descriptor, &file_status) != 0) {
+        throw std::runtime_error("Failed to read the size of file: " + file_name.string());
+    }
+    return file_status.st_size;
+}
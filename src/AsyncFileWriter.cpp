@@ -0,0 +1,149 @@
+/**
+* @file AsyncFileWriter.cpp
+* @brief This module provides the implementation of the AsyncFileWriter class.
+* @author Iole Bolognesi
+*
+* Write requests are handed to the writer threads through a BoundedQueue, so
+* the caller blocks only once queue_depth files are waiting. With no writer
+* threads, files are written synchronously by the caller. The first error
+* raised by a writer is rethrown to the caller by the next write or finish.
+*/
+
+#include "AsyncFileWriter.hpp"
+
+#include <stdexcept>
+
+/**
+ * @brief Constructs an AsyncFileWriter and starts its writer threads.
+ *
+ * @param n_writers    Number of writer threads; 0 writes files synchronously.
+ * @param queue_depth  Maximum number of files waiting to be written.
+ */
+AsyncFileWriter::AsyncFileWriter(unsigned int n_writers, size_t queue_depth)
+    : requests(queue_depth) {
+
+    for (unsigned int writer_id = 0; writer_id < n_writers; writer_id++) {
+        writers.emplace_back(&AsyncFileWriter::writerLoop, this);
+    }
+}
+
+/**
+ * @brief Writes the remaining files and joins the writer threads. Errors are
+ * not reported: call finish to check them.
+ */
+AsyncFileWriter::~AsyncFileWriter() {
+
+    requests.close();
+
+    for (auto &writer : writers) {
+        if (writer.joinable()) {
+            writer.join();
+        }
+    }
+}
+
+/**
+ * @brief Returns a buffer to fill with the contents of a file, reusing the 
+ * buffer of a file already written if there is one.
+ *
+ * @return An empty buffer, possibly with capacity left from a previous file.
+ */
+ByteBuffer AsyncFileWriter::takeBuffer() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (free_buffers.empty()) {
+        return ByteBuffer();
+    }
+    ByteBuffer buffer = std::move(free_buffers.back());
+    free_buffers.pop_back();
+    return buffer;
+}
+
+/**
+ * @brief Queues a file to be written, waiting while the queue is full.
+ *
+ * @param file_name  Path to the file to write.
+ * @param buffer     Buffer holding the contents of the file; it is recycled 
+ *                   once written.
+ * @param length     Number of bytes of the buffer to write.
+ *
+ * @throws std::runtime_error if a previous file could not be written.
+ */
+void AsyncFileWriter::write(const std::filesystem::path file_name, ByteBuffer buffer, 
+                            size_t length) {
+
+    rethrowError();
+
+    if (writers.empty()) {
+        saveFile(file_name, buffer.data(), length);
+        recycleBuffer(std::move(buffer));
+        return;
+    }
+
+    if (!requests.push({file_name, std::move(buffer), length})) {
+        throw std::runtime_error("Write queue closed before writing: " + file_name.string());
+    }
+}
+
+/**
+ * @brief Waits until all queued files are written and stops the writer threads.
+ *
+ * @throws std::runtime_error if a file could not be written.
+ */
+void AsyncFileWriter::finish() {
+
+    requests.close();
+
+    for (auto &writer : writers) {
+        if (writer.joinable()) {
+            writer.join();
+        }
+    }
+
+    rethrowError();
+}
+
+/**
+ * @brief Main loop of a writer thread: writes queued files until the queue 
+ * is closed and drained.
+ */
+void AsyncFileWriter::writerLoop() {
+
+    while (std::optional<WriteRequest> request = requests.pop()) {
+        try {
+            saveFile(request->file_name, request->data.data(), request->length);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+        recycleBuffer(std::move(request->data));
+    }
+}
+
+/**
+ * @brief Makes a buffer available to takeBuffer, once written or, for a
+ * buffer taken but not written, once no longer in use.
+ *
+ * @param buffer  Buffer no longer in use.
+ */
+void AsyncFileWriter::recycleBuffer(ByteBuffer buffer) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    free_buffers.push_back(std::move(buffer));
+}
+
+/**
+ * @brief Rethrows the first error raised by a writer thread, if any.
+ */
+void AsyncFileWriter::rethrowError() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,137 @@
+/**
+* @file AuthenticatedTransform.cpp
+* @brief This module provides the layout of the authenticated cipher-text
+* of a file and the encryption and decryption of its chunks.
+* @author Iole Bolognesi
+*
+* The cipher-text of a file of n bytes holds the n encrypted bytes, at the
+* same positions as in the plain-text, followed by one tag per chunk. Every
+* file has at least one tag, so that empty files are authenticated too.
+*/
+
+#include "AuthenticatedTransform.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @brief Computes the number of chunks, and so of tags, of a file.
+ *
+ * @param plaintext_size  Size in bytes of the plain-text.
+ * @return The number of chunks, at least 1.
+ */
+size_t authenticatedChunks(size_t plaintext_size){
+
+    return std::max<size_t>(1, (plaintext_size + AUTH_CHUNK_BYTES - 1) / AUTH_CHUNK_BYTES);
+}
+
+/**
+ * @brief Computes the size of the cipher-text of a file, tags included.
+ *
+ * @param plaintext_size  Size in bytes of the plain-text.
+ * @return The size in bytes of the cipher-text.
+ */
+size_t authenticatedSize(size_t plaintext_size){
+
+    return plaintext_size + authenticatedChunks(plaintext_size) * N_TAG_BYTES;
+}
+
+/**
+ * @brief Computes the size of the plain-text of a file from the size of its
+ * cipher-text, the inverse of authenticatedSize.
+ *
+ * Every chunk but the last takes AUTH_CHUNK_BYTES + N_TAG_BYTES bytes of
+ * the cipher-text, and the last one between N_TAG_BYTES and that.
+ *
+ * @param encrypted_size  Size in bytes of the cipher-text.
+ * @return The size in bytes of the plain-text.
+ *
+ * @throws std::runtime_error if no plain-text has a cipher-text of this size.
+ */
+size_t authenticatedPayloadSize(size_t encrypted_size){
+
+    size_t n_chunks = std::max<size_t>(1, (encrypted_size + AUTH_CHUNK_BYTES + N_TAG_BYTES - 1) /
+                                        (AUTH_CHUNK_BYTES + N_TAG_BYTES));
+
+    if (encrypted_size < n_chunks * N_TAG_BYTES ||
+        authenticatedSize(encrypted_size - n_chunks * N_TAG_BYTES) != encrypted_size) {
+        throw std::runtime_error("Invalid size of authenticated cipher-text: " +
+                                std::to_string(encrypted_size));
+    }
+
+    return encrypted_size - n_chunks * N_TAG_BYTES;
+}
+
+/**
+ * @brief Derives the nonce of a chunk from the IV of its file.
+ *
+ * @param nonce         Pointer to a buffer of file_iv.size() bytes.
+ * @param file_iv       IV of the file.
+ * @param chunk_offset  Offset of the first byte of the chunk within the file.
+ */
+void AuthenticatedTransform::chunkNonce(unsigned char *nonce, const CryptoPP::SecByteBlock &file_iv,
+                                        size_t chunk_offset){
+
+    std::copy(file_iv.begin(), file_iv.end(), nonce);
+
+    for (size_t byte = 0; byte < 8 && byte < file_iv.size(); byte++) {
+        nonce[file_iv.size() - 1 - byte] ^= static_cast<unsigned char>(chunk_offset >> (8 * byte));
+    }
+}
+
+/**
+ * @brief Encrypts a chunk of a file and writes its tag after the cipher-text
+ * of the file.
+ *
+ * @param output          Pointer to the cipher-text of the file, of
+ *                        authenticatedSize(plaintext_size) bytes (may equal input).
+ * @param input           Pointer to the plain-text of the file.
+ * @param plaintext_size  Size in bytes of the plain-text of the file.
+ * @param chunk           Index of the chunk within the file.
+ * @param file_iv         IV of the file, of the length of the IV of the transform.
+ */
+void AuthenticatedTransform::encryptChunk(unsigned char *output, const unsigned char *input,
+                                        size_t plaintext_size, size_t chunk,
+                                        const CryptoPP::SecByteBlock &file_iv){
+
+    size_t chunk_offset = chunk * AUTH_CHUNK_BYTES;
+    size_t length = std::min<size_t>(AUTH_CHUNK_BYTES, plaintext_size - chunk_offset);
+    unsigned char last = chunk + 1 == authenticatedChunks(plaintext_size);
+
+    CryptoPP::SecByteBlock nonce(iv.size());
+    chunkNonce(nonce, file_iv, chunk_offset);
+
+    seal(output + chunk_offset, output + plaintext_size + chunk * N_TAG_BYTES,
+        input + chunk_offset, length, nonce, &last, 1);
+}
+
+/**
+ * @brief Decrypts a chunk of a file and verifies its tag.
+ *
+ * @param output          Pointer to the plain-text buffer of the file, of
+ *                        plaintext_size bytes (may equal input).
+ * @param input           Pointer to the cipher-text of the file, tags included.
+ * @param plaintext_size  Size in bytes of the plain-text of the file.
+ * @param chunk           Index of the chunk within the file.
+ * @param file_iv         IV of the file, of the length of the IV of the transform.
+ *
+ * @throws std::runtime_error if the chunk does not match its tag, e.g.
+ *         because the cipher-text was modified or the key is wrong.
+ */
+void AuthenticatedTransform::decryptChunk(unsigned char *output, const unsigned char *input,
+                                        size_t plaintext_size, size_t chunk,
+                                        const CryptoPP::SecByteBlock &file_iv){
+
+    size_t chunk_offset = chunk * AUTH_CHUNK_BYTES;
+    size_t length = std::min<size_t>(AUTH_CHUNK_BYTES, plaintext_size - chunk_offset);
+    unsigned char last = chunk + 1 == authenticatedChunks(plaintext_size);
+
+    CryptoPP::SecByteBlock nonce(iv.size());
+    chunkNonce(nonce, file_iv, chunk_offset);
+
+    if (!open(output + chunk_offset, input + plaintext_size + chunk * N_TAG_BYTES,
+            input + chunk_offset, length, nonce, &last, 1)) {
+        throw std::runtime_error("Authentication failed for the chunk at offset " +
+                                std::to_string(chunk_offset) + " of a file");
+    }
+}
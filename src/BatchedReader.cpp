@@ -0,0 +1,380 @@
+/**
+* @file BatchedReader.cpp
+* @brief This module provides the implementation of the BatchedReader class.
+* @author Iole Bolognesi
+*
+* With io_uring, each buffer is a slot holding one piece of a file. Free
+* slots are filled with the next pieces in file order and their reads are
+* submitted together; completed slots are handed to the consumer and reused.
+* Files are opened when their first piece is submitted and closed once all
+* their pieces have been consumed. Pieces are numbered when submitted, so
+* that they can also be handed over in that order.
+*/
+
+#include "BatchedReader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef USE_IO_URING
+#include <liburing.h>
+#endif
+
+/**
+ * @brief Opens a file for reading.
+ *
+ * @param file_name  Path to the file to open.
+ * @return The file descriptor.
+ *
+ * @throws std::runtime_error if the file cannot be opened.
+ */
+static int openForReading(const std::filesystem::path &file_name){
+
+    int fd = open(file_name.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file for reading: " + file_name.string() +
+                                " (" + std::strerror(errno) + ")");
+    }
+    return fd;
+}
+
+/**
+ * @brief Constructs a BatchedReader.
+ *
+ * @param queue_depth  Maximum number of reads in flight. A value of 0 is
+ *                     treated as 1.
+ * @param in_order     Whether pieces are handed over in file order rather
+ *                     than in completion order, e.g. for chained cipher modes.
+ */
+BatchedReader::BatchedReader(unsigned int queue_depth, bool in_order)
+    : queue_depth(queue_depth == 0 ? 1 : queue_depth), in_order(in_order) {
+
+    buffers.resize(static_cast<size_t>(this->queue_depth) * READ_BUFFER_BYTES);
+}
+
+/**
+ * @brief Tells whether the reader was built with the io_uring backend.
+ *
+ * @return true if reads are issued through io_uring; false if they are
+ *         issued one at a time with pread.
+ */
+bool BatchedReader::usesIoUring(){
+
+#ifdef USE_IO_URING
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Reads a list of files, handing each piece to a consumer function.
+ *
+ * Every file is handed over in pieces of at most READ_BUFFER_BYTES, each
+ * starting at a multiple of READ_BUFFER_BYTES. An empty file is handed over
+ * as a single piece of length 0.
+ *
+ * @param files        Paths to the files to read.
+ * @param files_sizes  Number of bytes to read from each file, normally its size.
+ * @param consume      Function receiving the pieces, called on the calling thread.
+ *
+ * @throws std::runtime_error if a file cannot be opened or holds fewer bytes
+ *         than expected.
+ */
+void BatchedReader::readFiles(const std::vector<std::filesystem::path> &files,
+                            const std::vector<size_t> &files_sizes, const Consumer &consume){
+
+#ifdef USE_IO_URING
+    readIoUring(files, files_sizes, consume);
+#else
+    readSequential(files, files_sizes, consume);
+#endif
+}
+
+/**
+ * @brief Reads a list of files one piece at a time with pread.
+ *
+ * @param files        Paths to the files to read.
+ * @param files_sizes  Number of bytes to read from each file.
+ * @param consume      Function receiving the pieces in file order.
+ */
+void BatchedReader::readSequential(const std::vector<std::filesystem::path> &files,
+                            const std::vector<size_t> &files_sizes, const Consumer &consume){
+
+    unsigned char *buffer = buffers.data();
+
+    for (size_t file_index = 0; file_index < files.size(); file_index++) {
+
+        size_t file_size = files_sizes[file_index];
+
+        if (file_size == 0) {
+            consume(file_index, 0, buffer, 0);
+            continue;
+        }
+
+        int fd = openForReading(files[file_index]);
+
+        try {
+            for (size_t file_offset = 0; file_offset < file_size; file_offset += READ_BUFFER_BYTES) {
+
+                size_t length = std::min<size_t>(READ_BUFFER_BYTES, file_size - file_offset);
+                size_t filled = 0;
+
+                while (filled < length) {
+                    ssize_t result = pread(fd, buffer + filled, length - filled, file_offset + filled);
+
+                    if (result < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (result <= 0) {
+                        throw std::runtime_error("Failed to read " + std::to_string(file_size) +
+                                                " bytes from file: " + files[file_index].string());
+                    }
+                    filled += result;
+                }
+
+                consume(file_index, file_offset, buffer, length);
+            }
+        }
+        catch (...) {
+            close(fd);
+            throw;
+        }
+        close(fd);
+    }
+}
+
+#ifdef USE_IO_URING
+
+/* State of one buffer of the reader */
+struct ReadSlot {
+    size_t file_index = 0;
+    size_t file_offset = 0;
+    size_t length = 0;
+    size_t filled = 0;
+    size_t sequence = 0;
+    bool busy = false;
+    bool done = false;
+};
+
+/**
+ * @brief Reads a list of files through io_uring, keeping up to queue_depth
+ * reads in flight.
+ *
+ * @param files        Paths to the files to read.
+ * @param files_sizes  Number of bytes to read from each file.
+ * @param consume      Function receiving the pieces, in completion order or
+ *                     in file order.
+ */
+void BatchedReader::readIoUring(const std::vector<std::filesystem::path> &files,
+                            const std::vector<size_t> &files_sizes, const Consumer &consume){
+
+    struct io_uring ring;
+    int status = io_uring_queue_init(queue_depth, &ring, 0);
+
+    if (status < 0) {
+        throw std::runtime_error(std::string("Failed to set up io_uring: ") + std::strerror(-status));
+    }
+
+    std::vector<ReadSlot> slots(queue_depth);
+    std::vector<unsigned int> free_slots;
+    std::vector<struct iovec> iovecs(queue_depth);
+
+    for (unsigned int slot = 0; slot < queue_depth; slot++) {
+        iovecs[slot].iov_base = buffers.data() + static_cast<size_t>(slot) * READ_BUFFER_BYTES;
+        iovecs[slot].iov_len = READ_BUFFER_BYTES;
+        free_slots.push_back(queue_depth - 1 - slot);
+    }
+
+    /* Registered buffers are mapped once rather than on every read, but count
+    against the locked memory limit: plain reads are used if that is too low */
+    bool fixed_buffers = io_uring_register_buffers(&ring, iovecs.data(), queue_depth) == 0;
+
+    std::vector<int> fds(files.size(), -1);
+    std::vector<size_t> pending_pieces(files.size(), 0);
+    unsigned int in_flight = 0;
+
+    /* Waits for the reads still in flight before the buffers can be released,
+    then closes the files and the ring, including when an error is thrown */
+    struct RingGuard {
+        struct io_uring &ring;
+        unsigned int &in_flight;
+        std::vector<int> &fds;
+
+        ~RingGuard() {
+            struct io_uring_cqe *cqe;
+            while (in_flight > 0 && io_uring_wait_cqe(&ring, &cqe) == 0) {
+                io_uring_cqe_seen(&ring, cqe);
+                in_flight--;
+            }
+            for (int fd : fds) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+            }
+            io_uring_queue_exit(&ring);
+        }
+    } guard{ring, in_flight, fds};
+
+    size_t next_file = 0;
+    size_t next_offset = 0;
+    size_t next_sequence = 0;
+    size_t deliver_sequence = 0;
+    unsigned int busy_slots = 0;
+
+    auto submitRead = [&](unsigned int slot){
+
+        ReadSlot &read_slot = slots[slot];
+        struct io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+
+        if (!sqe) {
+            throw std::runtime_error("io_uring submission queue is full");
+        }
+
+        unsigned char *destination = static_cast<unsigned char *>(iovecs[slot].iov_base) +
+                                    read_slot.filled;
+        unsigned int n_bytes = read_slot.length - read_slot.filled;
+        size_t offset = read_slot.file_offset + read_slot.filled;
+
+        if (fixed_buffers) {
+            io_uring_prep_read_fixed(sqe, fds[read_slot.file_index], destination, n_bytes,
+                                    offset, slot);
+        }
+        else {
+            io_uring_prep_read(sqe, fds[read_slot.file_index], destination, n_bytes, offset);
+        }
+        io_uring_sqe_set_data64(sqe, slot);
+        in_flight++;
+    };
+
+    auto consumeSlot = [&](unsigned int slot){
+
+        ReadSlot &read_slot = slots[slot];
+        size_t file_index = read_slot.file_index;
+
+        consume(file_index, read_slot.file_offset,
+                static_cast<const unsigned char *>(iovecs[slot].iov_base), read_slot.length);
+
+        /* The file is closed once all of its pieces have been consumed */
+        if (--pending_pieces[file_index] == 0 && next_file > file_index && fds[file_index] >= 0) {
+            close(fds[file_index]);
+            fds[file_index] = -1;
+        }
+
+        read_slot.busy = false;
+        free_slots.push_back(slot);
+        busy_slots--;
+    };
+
+    while (next_file < files.size() || busy_slots > 0) {
+
+        /* Fill the free buffers with the next pieces */
+        while (!free_slots.empty() && next_file < files.size()) {
+
+            unsigned int slot = free_slots.back();
+            free_slots.pop_back();
+
+            size_t file_size = files_sizes[next_file];
+            ReadSlot &read_slot = slots[slot];
+
+            read_slot.file_index = next_file;
+            read_slot.file_offset = next_offset;
+            read_slot.length = std::min<size_t>(READ_BUFFER_BYTES, file_size - next_offset);
+            read_slot.filled = 0;
+            read_slot.sequence = next_sequence++;
+            read_slot.busy = true;
+            read_slot.done = file_size == 0;
+
+            pending_pieces[next_file]++;
+            busy_slots++;
+
+            if (file_size > 0) {
+                if (next_offset == 0) {
+                    fds[next_file] = openForReading(files[next_file]);
+                }
+                submitRead(slot);
+            }
+
+            next_offset += read_slot.length;
+            if (next_offset >= file_size) {
+                next_file++;
+                next_offset = 0;
+            }
+        }
+
+        /* Wait for at least one read, then collect all completed ones */
+        if (in_flight > 0) {
+
+            status = io_uring_submit(&ring);
+            if (status < 0) {
+                throw std::runtime_error(std::string("Failed to submit reads: ") +
+                                        std::strerror(-status));
+            }
+
+            struct io_uring_cqe *cqe;
+            status = io_uring_wait_cqe(&ring, &cqe);
+            if (status < 0) {
+                throw std::runtime_error(std::string("Failed to wait for reads: ") +
+                                        std::strerror(-status));
+            }
+
+            do {
+                unsigned int slot = io_uring_cqe_get_data64(cqe);
+                int result = cqe->res;
+                io_uring_cqe_seen(&ring, cqe);
+                in_flight--;
+
+                ReadSlot &read_slot = slots[slot];
+                const std::filesystem::path &file_name = files[read_slot.file_index];
+
+                if (result < 0) {
+                    throw std::runtime_error("Failed to read file: " + file_name.string() +
+                                            " (" + std::strerror(-result) + ")");
+                }
+                if (result == 0) {
+                    throw std::runtime_error("File changed size during reading: " +
+                                            file_name.string());
+                }
+
+                /* Short reads are resubmitted for the remaining bytes */
+                read_slot.filled += result;
+                if (read_slot.filled < read_slot.length) {
+                    submitRead(slot);
+                }
+                else {
+                    read_slot.done = true;
+                }
+            }
+            while (io_uring_peek_cqe(&ring, &cqe) == 0);
+        }
+
+        /* Hand over the completed pieces */
+        if (in_order) {
+            bool delivered = true;
+            while (delivered) {
+                delivered = false;
+                for (unsigned int slot = 0; slot < queue_depth; slot++) {
+                    if (slots[slot].busy && slots[slot].done &&
+                        slots[slot].sequence == deliver_sequence) {
+                        consumeSlot(slot);
+                        deliver_sequence++;
+                        delivered = true;
+                    }
+                }
+            }
+        }
+        else {
+            for (unsigned int slot = 0; slot < queue_depth; slot++) {
+                if (slots[slot].busy && slots[slot].done) {
+                    consumeSlot(slot);
+                }
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,118 @@
+/**
+* @file ChunkedEngine.cpp
+* @brief This module provides the implementation of the ChunkedEngine class.
+* @author Iole Bolognesi
+*
+* This module uses the Crypto++ Seek method of random-access ciphers to
+* encrypt and decrypt the chunks of a buffer independently and in parallel.
+* The output is byte-identical to a single ProcessData call over the whole
+* buffer made by an encryptor positioned at the same offset of the file.
+*/
+
+#include "ChunkedEngine.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @brief Processes a buffer chunk by chunk across the threads of a pool.
+ *
+ * Each chunk is processed by the Crypto++ object of the worker that claims it,
+ * after restarting that object from the IV of the file and seeking it to the
+ * position of the chunk within the file.
+ *
+ * @param pool         Thread pool running the chunks.
+ * @param objects      One Crypto++ encryption or decryption object per worker.
+ * @param chunk_bytes  Size of each chunk in bytes.
+ * @param output       Pointer to the output buffer (may equal input).
+ * @param input        Pointer to the input buffer.
+ * @param length       Number of bytes to process.
+ * @param file_iv      IV of the file.
+ * @param file_offset  Position of the first input byte within the file.
+ */
+static void processChunks(ThreadPool &pool, 
+                        std::vector<std::unique_ptr<StreamTransform>> &objects,
+                        size_t chunk_bytes, unsigned char *output,
+                        const unsigned char *input, size_t length,
+                        const CryptoPP::SecByteBlock &file_iv, size_t file_offset){
+
+    size_t n_chunks = (length + chunk_bytes - 1) / chunk_bytes;
+
+    pool.parallelFor(n_chunks, [&](size_t chunk, unsigned int worker_id){
+
+        size_t chunk_offset = chunk * chunk_bytes;
+        size_t chunk_size = std::min(chunk_bytes, length - chunk_offset);
+
+        /* Crypto++ object of this worker */
+        StreamTransform &crypto_object = *objects[worker_id];
+
+        crypto_object.resynchronize(file_iv, file_iv.size());
+        crypto_object.seek(file_offset + chunk_offset);
+        crypto_object.process(output + chunk_offset, input + chunk_offset, chunk_size);
+    });
+}
+
+/**
+ * @brief Constructs a ChunkedEngine for a cipher.
+ *
+ * The engine is enabled only if the cipher supports seeking and the pool has
+ * more than one thread. In that case one encryptor and one decryptor are
+ * created per worker, so that the key schedule is computed once per thread
+ * rather than once per chunk.
+ *
+ * @param cipher       Cipher providing the key, IV, and Crypto++ objects.
+ * @param pool         Thread pool the chunks are processed on.
+ * @param chunk_bytes  Size of each chunk in bytes.
+ *
+ * @throws std::invalid_argument if chunk_bytes is 0.
+ */
+ChunkedEngine::ChunkedEngine(Cipher &cipher, ThreadPool &pool, size_t chunk_bytes)
+    : pool(pool), chunk_bytes(chunk_bytes),
+      enabled(cipher.supportsSeeking() && pool.size() > 1) {
+
+    if (chunk_bytes == 0) {
+        throw std::invalid_argument("Chunk size must be greater than zero");
+    }
+
+    if (!enabled) {
+        return;
+    }
+
+    encryptors.push_back(cipher.createEncryptor());
+    decryptors.push_back(cipher.createDecryptor());
+
+    for (unsigned int worker_id = 1; worker_id < pool.size(); worker_id++) {
+        encryptors.push_back(encryptors[0]->clone());
+        decryptors.push_back(decryptors[0]->clone());
+    }
+}
+
+/**
+ * @brief Encrypts a buffer in parallel chunks.
+ *
+ * @param output       Pointer to the cipher-text buffer (may equal input).
+ * @param input        Pointer to the plain-text buffer.
+ * @param length       Number of bytes to encrypt.
+ * @param file_iv      IV of the file.
+ * @param file_offset  Position of the first plain-text byte within the file.
+ */
+void ChunkedEngine::encrypt(unsigned char *output, const unsigned char *input, size_t length,
+                            const CryptoPP::SecByteBlock &file_iv, size_t file_offset){
+
+    processChunks(pool, encryptors, chunk_bytes, output, input, length, file_iv, file_offset);
+}
+
+/**
+ * @brief Decrypts a buffer in parallel chunks.
+ *
+ * @param output       Pointer to the plain-text buffer (may equal input).
+ * @param input        Pointer to the cipher-text buffer.
+ * @param length       Number of bytes to decrypt.
+ * @param file_iv      IV of the file.
+ * @param file_offset  Position of the first cipher-text byte within the file.
+ */
+void ChunkedEngine::decrypt(unsigned char *output, const unsigned char *input, size_t length,
+                            const CryptoPP::SecByteBlock &file_iv, size_t file_offset){
+
+    processChunks(pool, decryptors, chunk_bytes, output, input, length, file_iv, file_offset);
+}
@@ -4,11 +4,16 @@
 * @author Iole Bolognesi 
 * 
 * This module uses the Crypto++ library for constructing objects
-* of the Cipher class (declared in Cipher.hpp)
+* of the Cipher class (declared in Cipher.hpp) and deriving the IV of
+* each file from their key and IV
 *
 */
 #include "Cipher.hpp"
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
+#include <hkdf.h>
+#include <sha.h>
 
 using namespace CryptoPP;
 /**
@@ -19,11 +24,12 @@ using namespace CryptoPP;
  * sequences of bytes. 
  *
  * @param n_key_bytes  Desired key length in bytes. 
+ * @param n_iv_bytes   Desired IV length in bytes. 
  **/
-Cipher::Cipher(int n_key_bytes){
+Cipher::Cipher(int n_key_bytes, int n_iv_bytes){
 
     SecByteBlock key(n_key_bytes);
-    SecByteBlock iv(N_BLOCK_BYTES); 
+    SecByteBlock iv(n_iv_bytes); 
 
     /* Initialize key and iv with randomly 
     generated sequence of bytes */
@@ -34,3 +40,54 @@ Cipher::Cipher(int n_key_bytes){
     this->key=key;
     this->iv=iv;
 }
+
+/**
+ * @brief Replaces the key and IV of the cipher, e.g. with the ones that
+ * encrypted a cipher-text being read back.
+ *
+ * The Crypto++ objects created afterwards use the new key and IV.
+ *
+ * @param key  Key of the same length as the current one.
+ * @param iv   IV of the same length as the current one.
+ *
+ * @throws std::runtime_error if the key or IV length does not match the cipher.
+ */
+void Cipher::setKeyWithIV(const SecByteBlock &key, const SecByteBlock &iv){
+
+    if(key.size() != this->key.size() || iv.size() != this->iv.size()){
+        throw std::runtime_error("Key or IV length does not match the cipher");
+    }
+
+    this->key=key;
+    this->iv=iv;
+}
+
+/**
+ * @brief Derives the IV of a file from the key and IV of the cipher and the 
+ * global index of the file.
+ *
+ * The IV is expanded with HKDF-SHA256 from the key, salted with the IV of 
+ * the cipher, and with the index of the file as context. The index is the 
+ * position of the file in the metadata, so the IV is not stored.
+ *
+ * @param file_index  Global index of the file.
+ * @return The IV of the file, of the same length as the IV of the cipher.
+ */
+SecByteBlock Cipher::fileIV(size_t file_index) const{
+
+    /* Context: a label and the index as 8 big-endian bytes */
+    const char label[] = "file iv";
+    unsigned char info[sizeof(label) + 8];
+    std::copy(label, label + sizeof(label), info);
+
+    for(size_t byte = 0; byte < 8; byte++){
+        info[sizeof(label) + byte] = static_cast<unsigned char>(file_index >> (8 * (7 - byte)));
+    }
+
+    SecByteBlock file_iv(iv.size());
+    HKDF<SHA256> hkdf;
+    hkdf.DeriveKey(file_iv, file_iv.size(), key, key.size(), iv, iv.size(), 
+                info, sizeof(info));
+
+    return file_iv;
+}
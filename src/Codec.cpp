@@ -0,0 +1,102 @@
+/**
+* @file Codec.cpp
+* @brief This module provides the methods shared by all the implementations
+* of the Codec class.
+* @author Iole Bolognesi
+*/
+
+#include "Codec.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+/**
+ * @brief Reads a file and compresses it, keeping it as it is if it does
+ * not shrink.
+ *
+ * @param file_name  Path to the file.
+ * @param file_size  Size of the file.
+ * @param mapped     Whether to compress straight from the mapped pages of
+ *                   the file, or else from a copy read into memory.
+ * @return The bytes to encrypt: the compressed file, or the file itself
+ *         if those are no fewer than file_size.
+ *
+ * @throws std::runtime_error if the file cannot be read or changed size.
+ */
+ByteBuffer Codec::compressFile(const std::filesystem::path file_name, size_t file_size,
+                            bool mapped){
+
+    if (!mapped) {
+        ByteBuffer contents(file_size);
+        loadFileInto(file_name, contents.data(), file_size);
+        return compressBuffer(std::move(contents));
+    }
+
+    MappedFile mapping(file_name);
+
+    if (mapping.size() != file_size) {
+        throw std::runtime_error("File changed size during compression: " +
+                                file_name.string());
+    }
+
+    ByteBuffer compressed(maxCompressedSize(file_size));
+    size_t compressed_size = compress(compressed.data(), compressed.size(), mapping.data(),
+                                    file_size);
+
+    if (compressed_size >= file_size) {
+        compressed.assign(mapping.data(), mapping.data() + file_size);
+        return compressed;
+    }
+
+    compressed.resize(compressed_size);
+    compressed.shrink_to_fit();
+
+    return compressed;
+}
+
+/**
+ * @brief Compresses contents already in memory, keeping them as they are
+ * if they do not shrink.
+ *
+ * @param contents  Contents of a file, taken over by the call.
+ * @return The bytes to encrypt: the compressed contents, or the contents
+ *         themselves if those are no fewer.
+ */
+ByteBuffer Codec::compressBuffer(ByteBuffer contents){
+
+    ByteBuffer compressed(maxCompressedSize(contents.size()));
+    size_t compressed_size = compress(compressed.data(), compressed.size(), contents.data(),
+                                    contents.size());
+
+    if (compressed_size >= contents.size()) {
+        return contents;
+    }
+
+    compressed.resize(compressed_size);
+    compressed.shrink_to_fit();
+
+    return compressed;
+}
+
+/**
+ * @brief Restores a file from the bytes stored by compressFile.
+ *
+ * @param output       Pointer to a buffer of at least orig_size bytes.
+ * @param orig_size    Size of the original file.
+ * @param input        Pointer to the stored bytes.
+ * @param stored_size  Number of stored bytes, equal to orig_size if the
+ *                     file was stored as it is.
+ *
+ * @throws std::runtime_error if the stored bytes do not decompress to
+ *         orig_size bytes.
+ */
+void Codec::expand(unsigned char *output, size_t orig_size, const unsigned char *input,
+                size_t stored_size){
+
+    if (stored_size == orig_size) {
+        std::memcpy(output, input, orig_size);
+        return;
+    }
+
+    decompress(output, orig_size, input, stored_size);
+}
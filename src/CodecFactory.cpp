@@ -0,0 +1,44 @@
+/**
+ * @file CodecFactory.cpp
+ * @brief This module provides the factory method for constructing 
+ * objects of the derived classes that implement the Codec class. 
+ * @author Iole Bolognesi 
+ **/
+
+#include <stdexcept>
+
+#include "CodecFactory.hpp"
+#include "ZstdCodec.hpp"
+#include "Lz4Codec.hpp"
+
+/**
+ * @brief Creates a concrete Codec class for the input CodecType.
+ *
+ * @param type   The CodecType enum of the desired codec.
+ * @param level  Compression level of zstd, or acceleration of lz4; 0 for
+ *               the default of the library.
+ *
+ * @return std::unique_ptr<Codec> to the requested codec;
+ *         nullptr if `type` is CODEC_NONE or unrecognized.
+ *
+ * @throws std::runtime_error if the codec was not built in.
+ */
+std::unique_ptr<Codec> CodecFactory::createCodec(CodecType type, int level)
+    {
+        switch (type)
+        {
+            case CODEC_NONE:  return nullptr;
+#ifdef USE_ZSTD
+            case CODEC_ZSTD:  return std::make_unique<ZstdCodec>(level);
+#else
+            case CODEC_ZSTD:  throw std::runtime_error("Built without zstd, rebuild with USE_ZSTD=1");
+#endif
+#ifdef USE_LZ4
+            case CODEC_LZ4:   return std::make_unique<Lz4Codec>(level);
+#else
+            case CODEC_LZ4:   throw std::runtime_error("Built without lz4, rebuild with USE_LZ4=1");
+#endif
+        }
+
+        return nullptr;
+    }
@@ -0,0 +1,344 @@
+/**
+* @file CryptoStage.cpp
+* @brief This module provides the implementation of the CryptoStage class.
+* @author Iole Bolognesi
+*
+* Every file starts a new cipher state from its own IV, derived from the 
+* master key and the index of the file, so the output for a file does not 
+* depend on the files before it.
+*
+* Buffers of a file are encrypted (or decrypted) by a single Crypto++ object
+* whose state carries over from one call to the next, unless the cipher is
+* random-access and threads are available, in which case the ChunkedEngine
+* processes them in parallel from the given position within the file. 
+*
+* Alternatively, whole files are processed in parallel, each thread with its
+* own Crypto++ object, in any mode.
+*
+* Authenticated modes encrypt and decrypt whole files, each as chunks that 
+* carry their own tag, so the chunks of a file are processed across the pool 
+* in the same way, or files in parallel.
+*
+* All paths produce the same output for the same sequence of calls.
+*/
+
+#include "CryptoStage.hpp"
+#include "cryptography.hpp"
+
+#include <limits>
+#include <stdexcept>
+
+/**
+ * @brief Constructs a CryptoStage for a cipher.
+ *
+ * @param cipher       Cipher providing the key, IV, and Crypto++ objects.
+ * @param pool         Thread pool used by the chunked engine or across files.
+ * @param chunk_bytes  Size of the chunks processed by each thread.
+ * @param threading    Whether threads process the chunks of a file or whole files.
+ */
+CryptoStage::CryptoStage(Cipher &cipher, ThreadPool &pool, size_t chunk_bytes,
+                        ThreadingType threading)
+    : cipher(cipher), pool(pool),
+      order_independent(cipher.supportsSeeking() || cipher.hasIndependentBlocks() ||
+                        cipher.isAuthenticated()),
+      file_parallel(threading == THREADS_FILES && pool.size() > 1),
+      authenticated(cipher.isAuthenticated()),
+      authenticated_chunks(authenticated && threading == THREADS_CHUNKS && pool.size() > 1) {
+
+    unsigned int n_objects = file_parallel || authenticated_chunks ? pool.size() : 1;
+
+    if (authenticated) {
+        authenticators.push_back(cipher.createAuthenticator());
+
+        for (unsigned int worker_id = 1; worker_id < n_objects; worker_id++) {
+            authenticators.push_back(authenticators[0]->clone());
+        }
+        return;
+    }
+
+    encryptors.push_back(cipher.createEncryptor());
+    decryptors.push_back(cipher.createDecryptor());
+
+    cached_files.assign(n_objects, std::numeric_limits<size_t>::max());
+    cached_ivs.resize(n_objects);
+
+    for (unsigned int worker_id = 1; worker_id < n_objects; worker_id++) {
+        encryptors.push_back(encryptors[0]->clone());
+        decryptors.push_back(decryptors[0]->clone());
+    }
+
+    /* The pool runs either files or chunks, never both at once */
+    if (threading == THREADS_CHUNKS) {
+        engine = std::make_unique<ChunkedEngine>(cipher, pool, chunk_bytes);
+    }
+}
+
+/**
+ * @brief Returns the Crypto++ name of the algorithm and mode.
+ *
+ * @return The algorithm name, e.g. "AES/CTR".
+ */
+std::string CryptoStage::algorithmName(){
+
+    if(authenticated){
+        return authenticators[0]->algorithmName();
+    }
+    return encryptors[0]->algorithmName();
+}
+
+/**
+ * @brief Computes the size of the cipher-text of a plain-text.
+ *
+ * @param plaintext_size  Size in bytes of the plain-text.
+ * @return The size in bytes of the cipher-text, including padding if the
+ *         cipher requires it, or the tags of authenticated modes.
+ */
+size_t CryptoStage::encryptedSize(size_t plaintext_size){
+
+    if(cipher.requiresPadding()){
+        return paddedSize(plaintext_size, N_BLOCK_BYTES);
+    }
+    if(authenticated){
+        return authenticatedSize(plaintext_size);
+    }
+    return plaintext_size;
+}
+
+/**
+ * @brief Runs task(file, worker_id) for every file in [0, n_files).
+ *
+ * Files run in parallel across the pool if the stage processes whole files
+ * in parallel, and otherwise in order on the calling thread as worker 0.
+ *
+ * @param n_files  Number of files.
+ * @param task     Processing of a single file.
+ */
+void CryptoStage::forEachFile(size_t n_files, const ThreadPool::Task &task){
+
+    if(file_parallel){
+        pool.parallelFor(n_files, task);
+        return;
+    }
+
+    for(size_t file=0; file<n_files; file++){
+        task(file, 0);
+    }
+}
+
+/**
+ * @brief Encrypts a buffer whose length is a multiple of the block size for
+ * ciphers that require padding.
+ *
+ * Buffers of a file are given in order, unless the cipher is random-access.
+ *
+ * @param output       Pointer to the cipher-text buffer (may equal input).
+ * @param input        Pointer to the plain-text buffer.
+ * @param length       Number of bytes to encrypt.
+ * @param file_index   Global index of the file the buffer belongs to.
+ * @param file_offset  Position of the first plain-text byte within the file.
+ * @param worker_id    Id of the calling worker, 0 unless files are 
+ *                     processed in parallel.
+ *
+ * @throws std::logic_error for authenticated modes, which encrypt whole 
+ *         files through encryptPadded.
+ */
+void CryptoStage::encrypt(unsigned char *output, const unsigned char *input, size_t length,
+                        size_t file_index, size_t file_offset, unsigned int worker_id){
+
+    if(authenticated){
+        throw std::logic_error("Authenticated modes encrypt whole files only");
+    }
+
+    if(isChunked()){
+
+        /* Encryption in parallel chunks, seeking to the position within the file */
+        engine->encrypt(output, input, length, fileIV(file_index, 0), file_offset);
+        return;
+    }
+
+    StreamTransform &encryption_object = *encryptors[worker_id];
+    positionObject(encryption_object, file_index, file_offset, worker_id);
+
+    /* Encryption */
+    encryption_object.process(output, input, length);
+}
+
+/**
+ * @brief Encrypts a whole plain-text, padding it if the cipher requires it,
+ * or authenticating it in chunks.
+ *
+ * The plain-text is not copied: its full blocks are encrypted directly from
+ * the input, and only the last partial block is padded in a small tail
+ * buffer (see copyPaddedTail). The input can therefore be read-only, e.g. a
+ * memory-mapped file.
+ *
+ * @param output          Pointer to a cipher-text buffer of encryptedSize(plaintext_size) bytes.
+ * @param input           Pointer to the plain-text, the whole file for 
+ *                        authenticated modes or its last piece otherwise.
+ * @param plaintext_size  Size in bytes of the plain-text.
+ * @param file_index      Global index of the file.
+ * @param file_offset     Position of the first plain-text byte within the file.
+ * @param worker_id       Id of the calling worker.
+ */
+void CryptoStage::encryptPadded(unsigned char *output, const unsigned char *input,
+                                size_t plaintext_size, size_t file_index, 
+                                size_t file_offset, unsigned int worker_id){
+
+    if(authenticated){
+        processAuthenticated(output, input, plaintext_size, file_index, worker_id, true);
+        return;
+    }
+
+    if(!cipher.requiresPadding()){
+        encrypt(output, input, plaintext_size, file_index, file_offset, worker_id);
+        return;
+    }
+
+    unsigned char tail[N_BLOCK_BYTES];
+    size_t body_size = copyPaddedTail(tail, input, plaintext_size, N_BLOCK_BYTES);
+
+    if(isChunked()){
+        encrypt(output, input, body_size, file_index, file_offset, worker_id);
+        encrypt(output + body_size, tail, N_BLOCK_BYTES, file_index, file_offset + body_size,
+                worker_id);
+        return;
+    }
+
+    /* The body and the padded tail are encrypted as a single batch, the 
+    state carrying over from one to the other */
+    StreamTransform &encryption_object = *encryptors[worker_id];
+    positionObject(encryption_object, file_index, file_offset, worker_id);
+
+    TransformJob jobs[2] = {{output, input, body_size, file_offset},
+                            {output + body_size, tail, N_BLOCK_BYTES, file_offset + body_size}};
+
+    encryption_object.processMany(jobs, 2, false);
+}
+
+/**
+ * @brief Decrypts the cipher-text of a file. Padding, if any, is left in 
+ * the output.
+ *
+ * With authenticated modes the plain-text is written to the start of the 
+ * output once verified.
+ *
+ * @param output      Pointer to the plain-text buffer (may equal input).
+ * @param input       Pointer to the cipher-text of the file.
+ * @param length      Size in bytes of the cipher-text of the file.
+ * @param file_index  Global index of the file.
+ * @param worker_id   Id of the calling worker, 0 unless files are 
+ *                    processed in parallel.
+ */
+void CryptoStage::decrypt(unsigned char *output, const unsigned char *input,
+                        size_t length, size_t file_index, unsigned int worker_id){
+
+    if(authenticated){
+        processAuthenticated(output, input, authenticatedPayloadSize(length), file_index, 
+                            worker_id, false);
+        return;
+    }
+
+    if(isChunked()){
+
+        /* Decryption in parallel chunks */
+        engine->decrypt(output, input, length, fileIV(file_index, 0), 0);
+        return;
+    }
+
+    StreamTransform &decryption_object = *decryptors[worker_id];
+    positionObject(decryption_object, file_index, 0, worker_id);
+
+    /* Decryption */
+    decryption_object.process(output, input, length);
+}
+
+/**
+ * @brief Encrypts or decrypts the chunks of a file with an authenticated 
+ * mode, across the pool if the stage processes chunks in parallel.
+ *
+ * @param output          Pointer to the cipher-text (encrypting) or 
+ *                        plain-text (decrypting) of the file.
+ * @param input           Pointer to the plain-text (encrypting) or 
+ *                        cipher-text (decrypting) of the file.
+ * @param plaintext_size  Size in bytes of the plain-text of the file.
+ * @param file_index      Global index of the file.
+ * @param worker_id       Id of the calling worker.
+ * @param encrypting      Whether to encrypt or to decrypt and verify.
+ *
+ * @throws std::runtime_error if a chunk fails verification.
+ */
+void CryptoStage::processAuthenticated(unsigned char *output, const unsigned char *input,
+                                    size_t plaintext_size, size_t file_index, 
+                                    unsigned int worker_id, bool encrypting){
+
+    size_t n_chunks = authenticatedChunks(plaintext_size);
+    CryptoPP::SecByteBlock file_iv = cipher.fileIV(file_index);
+
+    auto processChunk = [&](size_t chunk, unsigned int id){
+        if(encrypting){
+            authenticators[id]->encryptChunk(output, input, plaintext_size, chunk, file_iv);
+        }
+        else{
+            authenticators[id]->decryptChunk(output, input, plaintext_size, chunk, file_iv);
+        }
+    };
+
+    if(authenticated_chunks && n_chunks > 1){
+        pool.parallelFor(n_chunks, processChunk);
+        return;
+    }
+
+    for(size_t chunk=0; chunk<n_chunks; chunk++){
+        processChunk(chunk, worker_id);
+    }
+}
+
+/**
+ * @brief Returns the IV of a file, derived once per file and worker.
+ *
+ * The buffers of a file arrive one after the other on the same worker, so 
+ * each worker keeps the IV of the last file it saw instead of running the 
+ * key derivation for every buffer.
+ *
+ * @param file_index  Global index of the file.
+ * @param worker_id   Id of the calling worker; 0 for the chunked engine.
+ * @return The IV of the file.
+ */
+const CryptoPP::SecByteBlock &CryptoStage::fileIV(size_t file_index, unsigned int worker_id){
+
+    if(cached_files[worker_id] != file_index){
+        cached_ivs[worker_id] = cipher.fileIV(file_index);
+        cached_files[worker_id] = file_index;
+    }
+    return cached_ivs[worker_id];
+}
+
+/**
+ * @brief Positions a Crypto++ object at a byte of a file.
+ *
+ * Random-access ciphers restart from the IV of the file and seek to the 
+ * byte. Other modes restart at the first byte of the file only, and carry 
+ * their state over from the previous buffer otherwise. ECB has no IV.
+ *
+ * @param crypto_object  Encryption or decryption object.
+ * @param file_index     Global index of the file.
+ * @param file_offset    Position within the file.
+ * @param worker_id      Id of the calling worker.
+ */
+void CryptoStage::positionObject(StreamTransform &crypto_object, size_t file_index, 
+                                size_t file_offset, unsigned int worker_id){
+
+    if(!cipher.usesIV()){
+        return;
+    }
+
+    if(cipher.supportsSeeking()){
+        const CryptoPP::SecByteBlock &file_iv = fileIV(file_index, worker_id);
+        crypto_object.resynchronize(file_iv, file_iv.size());
+        crypto_object.seek(file_offset);
+    }
+    else if(file_offset == 0){
+        const CryptoPP::SecByteBlock &file_iv = fileIV(file_index, worker_id);
+        crypto_object.resynchronize(file_iv, file_iv.size());
+    }
+}
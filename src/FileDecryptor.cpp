@@ -0,0 +1,57 @@
+/**
+* @file FileDecryptor.cpp
+* @brief This module provides the implementation of the FileDecryptor class.
+* @author Iole Bolognesi
+*
+* Every file is encrypted from the start of its own cipher state, with an IV
+* derived from the key and the global index of the file (Cipher::fileIV), so
+* a file is decrypted from its own cipher-text only, in any mode:
+* - CBC, CFB, OFB, CTR and ChaCha20 restart the decryptor from the IV of
+*   the file.
+* - ECB encrypts every block independently and needs no IV.
+* - GCM and ChaCha20-Poly1305 derive the nonce of each chunk of the file
+*   from its IV, and verify the chunks against the tags after the file.
+*/
+
+#include <memory>
+
+#include "FileDecryptor.hpp"
+
+/**
+ * @brief Decrypts the cipher-text of a file. Padding, if any, is left in
+ * the output.
+ *
+ * @param output      Pointer to the plain-text buffer of length bytes.
+ * @param input       Pointer to the cipher-text of the file.
+ * @param length      Size of the cipher-text of the file, including the
+ *                    tags of authenticated modes.
+ * @param file_index  Global index of the file, its position in the metadata.
+ *
+ * @throws std::runtime_error if a chunk of an authenticated file fails
+ *         verification.
+ */
+void FileDecryptor::decrypt(unsigned char *output, const unsigned char *input, size_t length,
+                            size_t file_index){
+
+    CryptoPP::SecByteBlock file_iv = cipher.fileIV(file_index);
+
+    if(cipher.isAuthenticated()){
+
+        std::unique_ptr<AuthenticatedTransform> authenticator = cipher.createAuthenticator();
+        size_t plaintext_size = authenticatedPayloadSize(length);
+
+        for(size_t chunk = 0; chunk < authenticatedChunks(plaintext_size); chunk++){
+            authenticator->decryptChunk(output, input, plaintext_size, chunk, file_iv);
+        }
+        return;
+    }
+
+    std::unique_ptr<StreamTransform> decryptor = cipher.createDecryptor();
+
+    if(cipher.usesIV()){
+        decryptor->resynchronize(file_iv, file_iv.size());
+    }
+
+    /* Decryption */
+    decryptor->process(output, input, length);
+}
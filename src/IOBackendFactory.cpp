@@ -0,0 +1,40 @@
+/**
+ * @file IOBackendFactory.cpp
+ * @brief This module provides the factory method for constructing 
+ * objects of the derived classes that implement the IOBackend class. 
+ * @author Iole Bolognesi 
+ **/
+
+#include "IOBackendFactory.hpp"
+#include "AdiosBackend.hpp"
+#include "MpiioBackend.hpp"
+#include "PosixBackend.hpp"
+
+/**
+ * @brief Creates a concrete IOBackend class for the input IOBackendType.
+ *
+ * @param type         The IOBackendType enum of the desired backend.
+ * @param adios        Reference to the ADIOS2 context object, used by the 
+ *                     ADIOS 2 backend.
+ * @param mpiio_hints  Comma-separated key=value hints, used by the MPI-IO 
+ *                     backend.
+ * @param direct_io    Whether the POSIX backend bypasses the page cache 
+ *                     with O_DIRECT.
+ *
+ * @return std::unique_ptr<IOBackend> to the requested backend;
+ *         nullptr if `type` is unrecognized.
+ */
+std::unique_ptr<IOBackend> IOBackendFactory::createBackend(IOBackendType type, 
+                                                adios2::ADIOS &adios,
+                                                const std::string mpiio_hints,
+                                                bool direct_io)
+    {
+        switch (type)
+        {
+            case BACKEND_ADIOS:  return std::make_unique<AdiosBackend>(adios);
+            case BACKEND_MPIIO:  return std::make_unique<MpiioBackend>(mpiio_hints);
+            case BACKEND_POSIX:  return std::make_unique<PosixBackend>(direct_io);
+        }
+
+        return nullptr;
+    }
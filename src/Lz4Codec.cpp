@@ -0,0 +1,96 @@
+/**
+* @file Lz4Codec.cpp
+* @brief This module provides the implementation of the Lz4Codec class.
+* @author Iole Bolognesi
+*
+* A single LZ4 block holds at most LZ4_MAX_INPUT_SIZE bytes, so larger
+* files are not compressed and are stored as they are.
+*/
+
+#ifdef USE_LZ4
+
+#include "Lz4Codec.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <lz4.h>
+
+/**
+ * @brief Constructs an Lz4Codec.
+ *
+ * @param level  Acceleration of the compression: 0 or 1 for the default,
+ *               higher values compressing faster and less.
+ */
+Lz4Codec::Lz4Codec(int level) : acceleration(level > 1 ? level : 1) {}
+
+/**
+ * @brief Returns the largest size that length bytes can compress to.
+ */
+size_t Lz4Codec::maxCompressedSize(size_t length){
+
+    if (length > LZ4_MAX_INPUT_SIZE) {
+        return length;
+    }
+    return LZ4_compressBound(static_cast<int>(length));
+}
+
+/**
+ * @brief Compresses a buffer into a single block.
+ *
+ * @param output    Pointer to a buffer of capacity bytes.
+ * @param capacity  Size of the output buffer, at least maxCompressedSize(length).
+ * @param input     Pointer to the bytes to compress.
+ * @param length    Number of bytes to compress.
+ * @return The size of the block; length if it is too large for a block,
+ *         so that it is stored as it is.
+ *
+ * @throws std::runtime_error if the compression fails.
+ */
+size_t Lz4Codec::compress(unsigned char *output, size_t capacity,
+                        const unsigned char *input, size_t length){
+
+    if (length > LZ4_MAX_INPUT_SIZE) {
+        return length;
+    }
+
+    int result = LZ4_compress_fast(reinterpret_cast<const char*>(input),
+                                reinterpret_cast<char*>(output), static_cast<int>(length),
+                                static_cast<int>(std::min<size_t>(capacity,
+                                                std::numeric_limits<int>::max())),
+                                acceleration);
+
+    if (result <= 0) {
+        throw std::runtime_error("lz4 compression failed");
+    }
+    return result;
+}
+
+/**
+ * @brief Decompresses a block.
+ *
+ * @param output             Pointer to a buffer of length bytes.
+ * @param length             Size of the original bytes.
+ * @param input              Pointer to the block.
+ * @param compressed_length  Size of the block.
+ *
+ * @throws std::runtime_error if the block is corrupt or does not hold
+ *         length bytes.
+ */
+void Lz4Codec::decompress(unsigned char *output, size_t length,
+                        const unsigned char *input, size_t compressed_length){
+
+    if (length > LZ4_MAX_INPUT_SIZE || compressed_length > LZ4_MAX_INPUT_SIZE) {
+        throw std::runtime_error("lz4 block larger than LZ4_MAX_INPUT_SIZE");
+    }
+
+    int result = LZ4_decompress_safe(reinterpret_cast<const char*>(input),
+                                    reinterpret_cast<char*>(output),
+                                    static_cast<int>(compressed_length),
+                                    static_cast<int>(length));
+
+    if (result < 0 || static_cast<size_t>(result) != length) {
+        throw std::runtime_error("lz4 decompression failed");
+    }
+}
+#endif
@@ -0,0 +1,634 @@
+/**
+* @file MpiioBackend.cpp
+* @brief This module provides the implementation of the MpiioBackend class.
+* @author Iole Bolognesi
+*
+* The cipher-text file holds the global cipher-text and nothing else: each
+* process writes its local cipher-text at its global offset. The metadata
+* file holds a header, a record per process, a record per file, and the
+* packed table of NUL-terminated file names, so each process writes its
+* records and names at fixed offsets.
+*
+* Every transfer is collective (MPI_File_write_at_all, MPI_File_read_at_all),
+* so that MPI-IO can apply collective buffering. Transfers are split into
+* pieces that fit the int count of MPI calls, and all processes issue the
+* same number of calls, passing no data once theirs is done.
+*
+* The files hold a single step: with the files kept open, each step rewrites
+* the previous one in place.
+*/
+
+#include "MpiioBackend.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string_view>
+
+/* Largest number of bytes moved by a single MPI-IO call */
+#define MAX_MPIIO_BYTES (1UL << 30)
+
+static const char metadata_file_magic[8] = {'C', 'T', 'M', 'P', 'I', 'I', 'O', '\0'};
+
+/* Header of a metadata file */
+struct MpiioMetadataHeader {
+    char magic[8];
+    uint64_t nproc;
+    uint64_t n_files;
+    uint64_t names_size;
+};
+
+/* Metadata of the local cipher-text of one process */
+struct MpiioProcessRecord {
+    uint64_t local_size;
+    uint64_t global_offset;
+    uint64_t local_count;
+    uint64_t names_size;
+    uint64_t names_offset;
+};
+
+/* Metadata of the cipher-text of one file */
+struct MpiioFileRecord {
+    uint64_t size;
+    uint64_t offset;
+    uint64_t orig_size;
+    uint64_t compressed_size;
+};
+
+/* Contiguous bytes of a file transferred by the calling process */
+struct MpiioFileRange {
+    MPI_Offset offset;
+    unsigned char *data;
+    size_t count;
+};
+
+/**
+ * @brief Throws if an MPI-IO call failed.
+ *
+ * @param error      Error code returned by the call.
+ * @param action     Description of the call, for the error message.
+ * @param file_name  Path to the file, for the error message.
+ *
+ * @throws std::runtime_error if error is not MPI_SUCCESS.
+ */
+static void checkMPI(int error, const std::string &action, const std::string &file_name){
+
+    if (error != MPI_SUCCESS) {
+        char message[MPI_MAX_ERROR_STRING];
+        int length;
+        MPI_Error_string(error, message, &length);
+        throw std::runtime_error("Failed to " + action + " file: " + file_name +
+                                " (" + std::string(message, length) + ")");
+    }
+}
+
+/**
+ * @brief Writes or reads ranges of a file collectively. Collective over the
+ * processes that opened the file.
+ *
+ * @param file       MPI file handle.
+ * @param ranges     Ranges of the file transferred by the calling process.
+ * @param write      Whether to write the ranges, or else to read them.
+ * @param file_name  Path to the file, for error messages.
+ *
+ * @throws std::runtime_error if a transfer fails.
+ */
+static void transferAll(MPI_File file, const std::vector<MpiioFileRange> &ranges, bool write,
+                        const std::string &file_name){
+
+    std::vector<MpiioFileRange> pieces;
+
+    for (const MpiioFileRange &range : ranges) {
+        for (size_t position = 0; position < range.count; position += MAX_MPIIO_BYTES) {
+            pieces.push_back({range.offset + static_cast<MPI_Offset>(position),
+                            range.data + position,
+                            std::min<size_t>(MAX_MPIIO_BYTES, range.count - position)});
+        }
+    }
+
+    size_t local_calls = pieces.size();
+    size_t n_calls;
+    reduce_and_broadcast(&local_calls, &n_calls, 1, MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+
+    /* Processes with fewer pieces take part with empty transfers */
+    pieces.resize(n_calls, MpiioFileRange{0, nullptr, 0});
+
+    for (const MpiioFileRange &piece : pieces) {
+
+        MPI_Status status;
+        int count = static_cast<int>(piece.count);
+
+        if (write) {
+            checkMPI(MPI_File_write_at_all(file, piece.offset, piece.data, count, MPI_BYTE,
+                                        &status), "write", file_name);
+        }
+        else {
+            checkMPI(MPI_File_read_at_all(file, piece.offset, piece.data, count, MPI_BYTE,
+                                        &status), "read", file_name);
+        }
+    }
+}
+
+/**
+ * @brief Reads and checks the header of a metadata file. Collective.
+ *
+ * @param file       MPI file handle.
+ * @param file_name  Path to the file, for error messages.
+ * @return The header.
+ *
+ * @throws std::runtime_error if the file is not an MPI-IO metadata file.
+ */
+static MpiioMetadataHeader readHeader(MPI_File file, const std::string &file_name){
+
+    MpiioMetadataHeader header;
+    transferAll(file, {{0, reinterpret_cast<unsigned char*>(&header), sizeof(header)}},
+                false, file_name);
+
+    if (std::memcmp(header.magic, metadata_file_magic, sizeof(metadata_file_magic)) != 0) {
+        throw std::runtime_error("Not an MPI-IO metadata file: " + file_name);
+    }
+
+    return header;
+}
+
+/**
+ * @brief Offset of the records of the files within a metadata file.
+ */
+static MPI_Offset fileRecordsOffset(size_t nproc){
+
+    return sizeof(MpiioMetadataHeader) + nproc * sizeof(MpiioProcessRecord);
+}
+
+/**
+ * @brief Offset of the table of file names within a metadata file.
+ */
+static MPI_Offset namesOffset(size_t nproc, size_t n_files){
+
+    return fileRecordsOffset(nproc) + n_files * sizeof(MpiioFileRecord);
+}
+
+/**
+ * @brief Splits a packed table of NUL-terminated names.
+ *
+ * @param names  Names, each followed by a NUL character.
+ * @param size   Size of the table in bytes.
+ * @return The names, in table order.
+ */
+static std::vector<std::string> splitNames(const char *names, size_t size){
+
+    std::vector<std::string> split;
+    size_t start = 0;
+
+    for (size_t end = 0; end < size; end++) {
+        if (names[end] == '\0') {
+            split.emplace_back(names + start, end - start);
+            start = end + 1;
+        }
+    }
+
+    return split;
+}
+
+/**
+ * @brief Constructs an MpiioBackend.
+ *
+ * @param hints  Comma-separated MPI-IO hints of the form key=value, e.g.
+ *               "cb_nodes=4,striping_factor=8"; empty for none.
+ *
+ * @throws std::runtime_error if a hint is not of the form key=value.
+ */
+MpiioBackend::MpiioBackend(const std::string hints){
+
+    MPI_Info_create(&info);
+
+    std::string_view remaining{hints};
+
+    while (!remaining.empty()) {
+
+        size_t comma = remaining.find(',');
+        std::string_view hint = remaining.substr(0, comma);
+        size_t separator = hint.find('=');
+
+        if (separator == std::string_view::npos || separator == 0) {
+            MPI_Info_free(&info);
+            throw std::runtime_error("Invalid MPI-IO hint: " + std::string(hint));
+        }
+
+        MPI_Info_set(info, std::string(hint.substr(0, separator)).c_str(),
+                    std::string(hint.substr(separator + 1)).c_str());
+
+        remaining = comma == std::string_view::npos ? std::string_view{} :
+                    remaining.substr(comma + 1);
+    }
+}
+
+/**
+ * @brief Frees the hints. Files must have been closed.
+ */
+MpiioBackend::~MpiioBackend(){
+
+    MPI_Info_free(&info);
+}
+
+/**
+ * @brief Opens a file on all processes, emptying it if opened for writing.
+ *
+ * A file opened for writing replaces a directory of the same name, such as
+ * one left by ADIOS 2 or created by setDirectory.
+ *
+ * @param file_name  Path to the file.
+ * @param write      Whether to open it for writing, or else for reading.
+ * @return The MPI file handle.
+ *
+ * @throws std::runtime_error if the file cannot be opened.
+ */
+MPI_File MpiioBackend::openFile(const std::string file_name, bool write){
+
+    if (write) {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+        if (rank == 0 && std::filesystem::is_directory(file_name)) {
+            std::filesystem::remove_all(file_name);
+        }
+        waitForProcesses();
+    }
+
+    MPI_File file;
+    int access_mode = write ? MPI_MODE_CREATE | MPI_MODE_WRONLY : MPI_MODE_RDONLY;
+
+    checkMPI(MPI_File_open(MPI_COMM_WORLD, file_name.c_str(), access_mode, info, &file),
+            "open", file_name);
+
+    if (write) {
+        checkMPI(MPI_File_set_size(file, 0), "truncate", file_name);
+    }
+
+    return file;
+}
+
+/**
+ * @brief Closes a file on all processes.
+ *
+ * @param file       Reference to the MPI file handle, reset to MPI_FILE_NULL.
+ * @param file_name  Path to the file, for error messages.
+ *
+ * @throws std::runtime_error if the file cannot be closed.
+ */
+void MpiioBackend::closeFile(MPI_File &file, const std::string file_name){
+
+    checkMPI(MPI_File_close(&file), "close", file_name);
+}
+
+/**
+ * @brief Opens the metadata file.
+ *
+ * @param file_name  Path to the file.
+ * @param write      Whether to open it for writing, or else for reading.
+ */
+void MpiioBackend::openMetadata(const std::string file_name, bool write){
+
+    metadata_file = openFile(file_name, write);
+    metadata_file_name = file_name;
+}
+
+/**
+ * @brief Closes the metadata file.
+ */
+void MpiioBackend::closeMetadata(){
+
+    closeFile(metadata_file, metadata_file_name);
+}
+
+/**
+ * @brief Opens the cipher-text file.
+ *
+ * @param file_name  Path to the file.
+ * @param write      Whether to open it for writing, or else for reading.
+ */
+void MpiioBackend::openData(const std::string file_name, bool write){
+
+    data_file = openFile(file_name, write);
+    data_file_name = file_name;
+}
+
+/**
+ * @brief Closes the cipher-text file.
+ */
+void MpiioBackend::closeData(){
+
+    closeFile(data_file, data_file_name);
+}
+
+/**
+ * @brief Writes the encryption metadata to the metadata file. Collective.
+ *
+ * Rank 0 writes the header along with its record, which follows it.
+ *
+ * @param nproc                 Total number of MPI processes writing metadata.
+ * @param rank                  MPI rank of the calling process.
+ * @param CT_local_size         Size of the local cipher-text.
+ * @param CT_global_offset      Offset of the local cipher-text within the global
+ *                              cipher-text.
+ * @param CTmeta_global_size    Total number of files across all processes.
+ * @param CTmeta_local_size     Number of local files.
+ * @param CTmeta_global_offset  Index of the first local file among all files.
+ * @param files_sizes           Size of the cipher-text of each local file.
+ * @param files_offsets         Offset of each local file within the local cipher-text.
+ * @param files_orig_sizes      Plain-text size of each local file.
+ * @param files_compressed_sizes  Number of bytes encrypted for each file, fewer than
+ *                               its plain-text size if it was compressed.
+ * @param files_names           NUL-terminated names of the local files.
+ * @param names_global_size     Size in bytes of the names of all files.
+ * @param names_global_offset   Offset of the local names within the names of all files.
+ */
+void MpiioBackend::writeMetadata(size_t nproc, size_t rank, size_t CT_local_size,
+                                size_t CT_global_offset, size_t CTmeta_global_size,
+                                size_t CTmeta_local_size, size_t CTmeta_global_offset,
+                                std::vector<size_t> &files_sizes,
+                                std::vector<size_t> &files_offsets,
+                                std::vector<size_t> &files_orig_sizes,
+                                std::vector<size_t> &files_compressed_sizes,
+                                const std::string &files_names, size_t names_global_size,
+                                size_t names_global_offset){
+
+    struct {
+        MpiioMetadataHeader header;
+        MpiioProcessRecord record;
+    } head;
+
+    std::memcpy(head.header.magic, metadata_file_magic, sizeof(head.header.magic));
+    head.header.nproc = nproc;
+    head.header.n_files = CTmeta_global_size;
+    head.header.names_size = names_global_size;
+    head.record = {CT_local_size, CT_global_offset, CTmeta_local_size, files_names.size(),
+                names_global_offset};
+
+    std::vector<MpiioFileRecord> file_records(CTmeta_local_size);
+    for (size_t i = 0; i < CTmeta_local_size; i++) {
+        file_records[i] = {files_sizes[i], files_offsets[i], files_orig_sizes[i],
+                        files_compressed_sizes[i]};
+    }
+
+    std::vector<MpiioFileRange> ranges;
+
+    if (rank == 0) {
+        ranges.push_back({0, reinterpret_cast<unsigned char*>(&head), sizeof(head)});
+    }
+    else {
+        ranges.push_back({static_cast<MPI_Offset>(sizeof(MpiioMetadataHeader) +
+                                                rank * sizeof(MpiioProcessRecord)),
+                        reinterpret_cast<unsigned char*>(&head.record), sizeof(MpiioProcessRecord)});
+    }
+
+    ranges.push_back({fileRecordsOffset(nproc) +
+                        static_cast<MPI_Offset>(CTmeta_global_offset * sizeof(MpiioFileRecord)),
+                    reinterpret_cast<unsigned char*>(file_records.data()),
+                    file_records.size() * sizeof(MpiioFileRecord)});
+
+    ranges.push_back({namesOffset(nproc, CTmeta_global_size) +
+                        static_cast<MPI_Offset>(names_global_offset),
+                    reinterpret_cast<unsigned char*>(const_cast<char*>(files_names.data())),
+                    files_names.size()});
+
+    transferAll(metadata_file, ranges, true, metadata_file_name);
+}
+
+/**
+ * @brief Reads the encryption metadata of the calling process from the
+ * metadata file. Collective.
+ *
+ * @param step                  Ignored: the file holds a single step.
+ * @param nproc                 Total number of MPI processes reading metadata.
+ * @param rank                  MPI rank of the calling process.
+ * @param CTmeta_global_offset  Index of the first local file among all files.
+ * @param CTmeta_local_size     Number of local files.
+ * @return The metadata of the local cipher-text.
+ *
+ * @throws std::runtime_error if the file was written by a different number of
+ *         processes or the number of names does not match the number of files.
+ */
+ParallelCTMeta MpiioBackend::readMetadata(size_t, size_t nproc, size_t rank,
+                                        size_t CTmeta_global_offset, size_t CTmeta_local_size){
+
+    MpiioMetadataHeader header = readHeader(metadata_file, metadata_file_name);
+
+    if (header.nproc != nproc || CTmeta_global_offset + CTmeta_local_size > header.n_files) {
+        throw std::runtime_error("Metadata does not match the processes reading it: " +
+                                metadata_file_name);
+    }
+
+    MpiioProcessRecord record;
+    std::vector<MpiioFileRecord> file_records(CTmeta_local_size);
+
+    transferAll(metadata_file, {
+            {static_cast<MPI_Offset>(sizeof(MpiioMetadataHeader) + rank * sizeof(MpiioProcessRecord)),
+            reinterpret_cast<unsigned char*>(&record), sizeof(record)},
+            {fileRecordsOffset(nproc) +
+                static_cast<MPI_Offset>(CTmeta_global_offset * sizeof(MpiioFileRecord)),
+            reinterpret_cast<unsigned char*>(file_records.data()),
+            file_records.size() * sizeof(MpiioFileRecord)}}, false, metadata_file_name);
+
+    /* The extent of the local names is needed before they can be read */
+    std::vector<char> names(record.names_size);
+
+    transferAll(metadata_file, {{namesOffset(nproc, header.n_files) +
+                                    static_cast<MPI_Offset>(record.names_offset),
+                                reinterpret_cast<unsigned char*>(names.data()), names.size()}},
+                false, metadata_file_name);
+
+    ParallelCTMeta metadata;
+    metadata.local_size = record.local_size;
+    metadata.global_offset = record.global_offset;
+
+    for (const MpiioFileRecord &file_record : file_records) {
+        metadata.files_sizes.push_back(file_record.size);
+        metadata.files_offsets.push_back(file_record.offset);
+        metadata.files_orig_sizes.push_back(file_record.orig_size);
+        metadata.files_compressed_sizes.push_back(file_record.compressed_size);
+    }
+
+    metadata.files_names = splitNames(names.data(), names.size());
+
+    if (metadata.files_names.size() != CTmeta_local_size) {
+        throw std::runtime_error("File names do not match the local metadata");
+    }
+
+    return metadata;
+}
+
+/**
+ * @brief Writes blocks of the cipher-text to the cipher-text file. Collective.
+ *
+ * @param blocks  Blocks written by the calling process, possibly none.
+ * @param shape   Size of the global cipher-text across all processes.
+ *
+ * @throws std::runtime_error if a block lies beyond the global cipher-text.
+ */
+void MpiioBackend::writeData(const std::vector<DataBlock> &blocks, size_t shape){
+
+    std::vector<MpiioFileRange> ranges;
+
+    for (const DataBlock &block : blocks) {
+        if (block.start + block.count > shape) {
+            throw std::runtime_error("Block beyond the end of the cipher-text of file: " +
+                                    data_file_name);
+        }
+        ranges.push_back({static_cast<MPI_Offset>(block.start),
+                        const_cast<unsigned char*>(block.data), block.count});
+    }
+
+    transferAll(data_file, ranges, true, data_file_name);
+}
+
+/**
+ * @brief Reads the local cipher-text from the cipher-text file. Collective.
+ *
+ * @param step   Ignored: the file holds a single step.
+ * @param count  Size of the local cipher-text.
+ * @param start  Offset of the local cipher-text within the global cipher-text.
+ * @return The local cipher-text.
+ */
+std::vector<uint8_t> MpiioBackend::readData(size_t, size_t count, size_t start){
+
+    std::vector<uint8_t> buffer(count);
+
+    transferAll(data_file, {{static_cast<MPI_Offset>(start), buffer.data(), count}}, false,
+                data_file_name);
+
+    return buffer;
+}
+
+/**
+ * @brief Writes the cipher-text to a file one buffer at a time, as it is
+ * encrypted by another thread. Each round writes one buffer per process,
+ * collectively, and all processes run n_rounds rounds.
+ *
+ * @param full_buffers  Queue of encrypted buffers, in cipher-text order.
+ *                      The producer closes it after the last buffer.
+ * @param free_buffers  Queue receiving the buffers once written.
+ * @param file_name     Path to the cipher-text file.
+ * @param shape         Size of the global cipher-text across all processes.
+ * @param count         Size of the local cipher-text.
+ * @param start         Offset of the local cipher-text within the global
+ *                      cipher-text.
+ * @param n_rounds      Maximum number of buffers across all processes.
+ *
+ * @throws std::runtime_error if the buffers received do not add up to count bytes.
+ */
+void MpiioBackend::streamWriteData(BoundedQueue<std::vector<uint8_t>> &full_buffers,
+                                BoundedQueue<std::vector<uint8_t>> &free_buffers,
+                                const std::string file_name, size_t shape, size_t count,
+                                size_t start, size_t n_rounds){
+
+    openData(file_name, true);
+
+    size_t written = 0;
+
+    for (size_t round = 0; round < n_rounds; round++) {
+
+        std::optional<std::vector<uint8_t>> buffer = full_buffers.pop();
+        std::vector<DataBlock> blocks;
+
+        if (buffer && !buffer->empty()) {
+            blocks.push_back({buffer->data(), start + written, buffer->size()});
+            written += buffer->size();
+        }
+
+        writeData(blocks, shape);
+
+        if (buffer) {
+            free_buffers.push(std::move(*buffer));
+        }
+    }
+
+    closeData();
+
+    if (written != count) {
+        throw std::runtime_error("Streamed cipher-text does not match the expected size");
+    }
+}
+
+/**
+ * @brief Reads the whole encryption metadata. Every calling process reads
+ * the metadata written by all processes. Collective.
+ *
+ * @param file_name  Path to the metadata file.
+ * @return The metadata of all files, in file order.
+ *
+ * @throws std::runtime_error if the file cannot be read or the number of
+ *         names does not match the number of files.
+ */
+GlobalCTMeta MpiioBackend::readGlobalMetadata(const std::string file_name){
+
+    MPI_File file = openFile(file_name, false);
+
+    MpiioMetadataHeader header = readHeader(file, file_name);
+
+    /* The records and the names follow the header contiguously */
+    std::vector<MpiioProcessRecord> process_records(header.nproc);
+    std::vector<MpiioFileRecord> file_records(header.n_files);
+    std::vector<char> names(header.names_size);
+
+    transferAll(file, {
+            {static_cast<MPI_Offset>(sizeof(MpiioMetadataHeader)),
+            reinterpret_cast<unsigned char*>(process_records.data()),
+            process_records.size() * sizeof(MpiioProcessRecord)},
+            {fileRecordsOffset(header.nproc), reinterpret_cast<unsigned char*>(file_records.data()),
+            file_records.size() * sizeof(MpiioFileRecord)},
+            {namesOffset(header.nproc, header.n_files),
+            reinterpret_cast<unsigned char*>(names.data()), names.size()}}, false, file_name);
+
+    closeFile(file, file_name);
+
+    GlobalCTMeta metadata;
+
+    for (const MpiioProcessRecord &record : process_records) {
+        metadata.local_sizes.push_back(record.local_size);
+        metadata.global_offsets.push_back(record.global_offset);
+        metadata.local_counts.push_back(record.local_count);
+    }
+
+    for (const MpiioFileRecord &record : file_records) {
+        metadata.files_sizes.push_back(record.size);
+        metadata.files_offsets.push_back(record.offset);
+        metadata.files_orig_sizes.push_back(record.orig_size);
+        metadata.files_compressed_sizes.push_back(record.compressed_size);
+    }
+
+    metadata.files_names = splitNames(names.data(), names.size());
+
+    if (metadata.files_names.size() != metadata.files_sizes.size()) {
+        throw std::runtime_error("File names do not match the metadata of " + file_name);
+    }
+
+    return metadata;
+}
+
+/**
+ * @brief Reads ranges of the cipher-text from a file. Collective.
+ *
+ * @param file_name  Path to the cipher-text file.
+ * @param starts     Offset of each range within the global cipher-text.
+ * @param counts     Size of each range.
+ * @return The bytes of each range.
+ */
+std::vector<std::vector<uint8_t>> MpiioBackend::readDataRanges(const std::string file_name,
+                                                const std::vector<size_t> &starts,
+                                                const std::vector<size_t> &counts){
+
+    std::vector<std::vector<uint8_t>> buffers(starts.size());
+    std::vector<MpiioFileRange> ranges;
+
+    for (size_t r = 0; r < starts.size(); r++) {
+        buffers[r].resize(counts[r]);
+        ranges.push_back({static_cast<MPI_Offset>(starts[r]), buffers[r].data(), counts[r]});
+    }
+
+    MPI_File file = openFile(file_name, false);
+    transferAll(file, ranges, false, file_name);
+    closeFile(file, file_name);
+
+    return buffers;
+}
@@ -0,0 +1,117 @@
+/**
+* @file NodeAggregator.cpp
+* @brief This module provides the implementation of the NodeAggregator class.
+* @author Iole Bolognesi
+*
+* The processes sharing memory (a node) are found with MPI_Comm_split_type and
+* split into groups of consecutive node ranks. Each group allocates a shared
+* window with one segment per process, contiguous in rank order. Staging is
+* the first phase of a write: each process copies its local cipher-text into
+* its segment. In the second phase the aggregator puts the staged cipher-texts
+* straight from the window, merging those that are adjacent both in the window
+* and in the global cipher-text into a single block. With processes placed on
+* nodes in blocks, as by default, each aggregator puts one block.
+*/
+
+#include "NodeAggregator.hpp"
+
+#include <cstring>
+
+#include "libpar.hpp"
+
+/**
+ * @brief Constructs a NodeAggregator. Collective over MPI_COMM_WORLD.
+ *
+ * @param ranks_per_aggregator  Number of processes of a node per aggregator;
+ *                              at least the number of processes per node
+ *                              gives one aggregator per node.
+ * @param local_size            Size of the local cipher-text.
+ * @param global_offset         Offset of the local cipher-text within the
+ *                              global cipher-text.
+ */
+NodeAggregator::NodeAggregator(size_t ranks_per_aggregator, size_t local_size,
+                            size_t global_offset) : local_size(local_size) {
+
+    int world_rank, node_rank, group_size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    /* Groups of consecutive processes of the same node, in world rank order */
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, world_rank, MPI_INFO_NULL,
+                        &node_comm);
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm_split(node_comm, node_rank / ranks_per_aggregator, node_rank, &group_comm);
+    MPI_Comm_rank(group_comm, &group_rank);
+    MPI_Comm_size(group_comm, &group_size);
+
+    MPI_Win_allocate_shared(static_cast<MPI_Aint>(local_size), 1, MPI_INFO_NULL, group_comm,
+                            &segment, &window);
+
+    /* Loads and stores are synchronised with MPI_Win_sync and barriers */
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+
+    /* The aggregator collects where each cipher-text of the group goes */
+    size_t extent[2] = {local_size, global_offset};
+    std::vector<size_t> extents(group_rank == 0 ? 2 * group_size : 0);
+    gather(extent, extents.data(), 2, MPI_UINT64_T, 0, group_comm);
+
+    if (group_rank == 0) {
+
+        for (int member = 0; member < group_size; member++) {
+
+            MPI_Aint segment_size;
+            int displacement_unit;
+            unsigned char *member_segment;
+            MPI_Win_shared_query(window, member, &segment_size, &displacement_unit,
+                                &member_segment);
+
+            size_t count = extents[2 * member];
+            size_t start = extents[2 * member + 1];
+
+            if (count == 0) {
+                continue;
+            }
+
+            if (!write_blocks.empty()) {
+                DataBlock &last = write_blocks.back();
+                if (last.start + last.count == start && last.data + last.count == member_segment) {
+                    last.count += count;
+                    continue;
+                }
+            }
+            write_blocks.push_back({member_segment, start, count});
+        }
+    }
+
+    size_t is_aggregator = group_rank == 0;
+    reduce_and_broadcast(&is_aggregator, &n_aggregators, 1, MPI_UINT64_T, MPI_SUM,
+                        MPI_COMM_WORLD);
+}
+
+/**
+ * @brief Frees the shared window and the communicators. Collective over
+ * MPI_COMM_WORLD.
+ */
+NodeAggregator::~NodeAggregator() {
+
+    MPI_Win_unlock_all(window);
+    MPI_Win_free(&window);
+    MPI_Comm_free(&group_comm);
+    MPI_Comm_free(&node_comm);
+}
+
+/**
+ * @brief Stages the local cipher-text in the shared window. Collective over
+ * the group: on return, the aggregator can put the blocks of the group.
+ *
+ * @param data  Pointer to the local cipher-text (local_size bytes).
+ */
+void NodeAggregator::aggregate(const unsigned char *data) {
+
+    if (local_size > 0) {
+        std::memcpy(segment, data, local_size);
+    }
+
+    MPI_Win_sync(window);
+    MPI_Barrier(group_comm);
+    MPI_Win_sync(window);
+}
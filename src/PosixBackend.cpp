@@ -0,0 +1,601 @@
+/**
+* @file PosixBackend.cpp
+* @brief This module provides the implementation of the PosixBackend class.
+* @author Iole Bolognesi
+*
+* The cipher-text and the metadata are each a directory holding one file per
+* process, named after the rank of the process. Cipher-text file i holds the
+* bytes of the global cipher-text written by process i, so the files, in rank
+* order, make up the global cipher-text; how many processes read it does not
+* matter. Metadata file i holds a header, a record per local file and the
+* NUL-terminated names of the local files of process i.
+*
+* No process ever opens the file of another when writing, so no locking or
+* collective buffering is involved. Each file is written with pwrite, after
+* its whole size is reserved with fallocate, and optionally with O_DIRECT
+* through the aligned buffers of an AlignedBufferPool.
+*
+* The files hold a single step: with the files kept open, each step rewrites
+* the previous one in place.
+*/
+
+#include "PosixBackend.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+static const char metadata_file_magic[8] = {'C', 'T', 'P', 'O', 'S', 'I', 'X', '\0'};
+
+/* Header of the metadata file of one process */
+struct PosixMetadataHeader {
+    char magic[8];
+    uint64_t nproc;
+    uint64_t rank;
+    uint64_t local_size;
+    uint64_t global_offset;
+    uint64_t local_count;
+    uint64_t first_file;
+    uint64_t n_files;
+    uint64_t names_size;
+};
+
+/* Metadata of the cipher-text of one file */
+struct PosixFileRecord {
+    uint64_t size;
+    uint64_t offset;
+    uint64_t orig_size;
+    uint64_t compressed_size;
+};
+
+/* Contents of the metadata file of one process */
+struct PosixMetadata {
+    PosixMetadataHeader header;
+    std::vector<PosixFileRecord> file_records;
+    std::vector<char> names;
+};
+
+/**
+ * @brief Path to the file of a process within a directory.
+ */
+static std::filesystem::path processFile(const std::filesystem::path &directory, size_t rank){
+
+    return directory / std::to_string(rank);
+}
+
+/**
+ * @brief Splits a packed table of NUL-terminated names.
+ *
+ * @param names  Names, each followed by a NUL character.
+ * @param size   Size of the table in bytes.
+ * @return The names, in table order.
+ */
+static std::vector<std::string> splitNames(const char *names, size_t size){
+
+    std::vector<std::string> split;
+    size_t start = 0;
+
+    for (size_t end = 0; end < size; end++) {
+        if (names[end] == '\0') {
+            split.emplace_back(names + start, end - start);
+            start = end + 1;
+        }
+    }
+
+    return split;
+}
+
+/**
+ * @brief Reads and checks the metadata file of one process.
+ *
+ * @param file       Metadata file, opened for reading.
+ * @param file_name  Path to the file, for error messages.
+ * @return The contents of the file.
+ *
+ * @throws std::runtime_error if the file is not a POSIX metadata file or is
+ *         truncated.
+ */
+static PosixMetadata readMetadataFile(AlignedFile &file, const std::filesystem::path &file_name){
+
+    PosixMetadata metadata;
+    size_t file_size = file.size();
+
+    if (file_size < sizeof(PosixMetadataHeader)) {
+        throw std::runtime_error("Not a POSIX metadata file: " + file_name.string());
+    }
+
+    std::vector<unsigned char> contents(file_size);
+    file.read(contents.data(), file_size, 0);
+    std::memcpy(&metadata.header, contents.data(), sizeof(PosixMetadataHeader));
+
+    const PosixMetadataHeader &header = metadata.header;
+    size_t records_size = header.local_count * sizeof(PosixFileRecord);
+
+    if (std::memcmp(header.magic, metadata_file_magic, sizeof(metadata_file_magic)) != 0 ||
+        file_size != sizeof(PosixMetadataHeader) + records_size + header.names_size) {
+        throw std::runtime_error("Not a POSIX metadata file: " + file_name.string());
+    }
+
+    const unsigned char *records = contents.data() + sizeof(PosixMetadataHeader);
+
+    metadata.file_records.resize(header.local_count);
+    std::memcpy(metadata.file_records.data(), records, records_size);
+    metadata.names.assign(records + records_size, records + records_size + header.names_size);
+
+    return metadata;
+}
+
+/**
+ * @brief Constructs a PosixBackend.
+ *
+ * @param direct  Whether to bypass the page cache with O_DIRECT, where the
+ *                file system allows it.
+ */
+PosixBackend::PosixBackend(bool direct) : direct(direct) {
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    this->rank = rank;
+}
+
+/**
+ * @brief Empties the directory of a file-per-process output, replacing any
+ * file or directory of the same name. Collective.
+ *
+ * @param directory  Path to the directory.
+ */
+void PosixBackend::prepareDirectory(const std::filesystem::path directory){
+
+    if (rank == 0) {
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+    }
+    waitForProcesses();
+}
+
+/**
+ * @brief Opens the metadata file of the calling process. Collective when
+ * opened for writing.
+ *
+ * @param file_name  Path to the metadata directory.
+ * @param write      Whether to open it for writing, or else for reading.
+ */
+void PosixBackend::openMetadata(const std::string file_name, bool write){
+
+    metadata_directory = file_name;
+
+    if (write) {
+        prepareDirectory(metadata_directory);
+    }
+
+    metadata_file = std::make_unique<AlignedFile>(processFile(metadata_directory, rank), write,
+                                                direct, pool);
+}
+
+/**
+ * @brief Closes the metadata file. Collective.
+ *
+ * The files of all processes are complete once it returns, so that any
+ * process can read them.
+ */
+void PosixBackend::closeMetadata(){
+
+    metadata_file.reset();
+    waitForProcesses();
+}
+
+/**
+ * @brief Opens the cipher-text. When writing, opens the file of the calling
+ * process; when reading, finds the files of all processes and where each
+ * starts within the global cipher-text. Collective.
+ *
+ * @param file_name  Path to the cipher-text directory.
+ * @param write      Whether to open it for writing, or else for reading.
+ *
+ * @throws std::runtime_error if there is no cipher-text file to read.
+ */
+void PosixBackend::openData(const std::string file_name, bool write){
+
+    data_directory = file_name;
+
+    if (write) {
+        prepareDirectory(data_directory);
+        data_file = std::make_unique<AlignedFile>(processFile(data_directory, rank), true,
+                                                direct, pool);
+        return;
+    }
+
+    /* Rank 0 lists the files and shares their sizes, rather than all
+    processes querying the file system */
+    std::vector<size_t> files_sizes;
+
+    if (rank == 0) {
+        std::error_code error;
+        for (size_t process = 0; ; process++) {
+            size_t size = std::filesystem::file_size(processFile(data_directory, process), error);
+            if (error) {
+                break;
+            }
+            files_sizes.push_back(size);
+        }
+    }
+
+    size_t n_files = files_sizes.size();
+    broadcast(&n_files, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+
+    if (n_files == 0) {
+        throw std::runtime_error("No cipher-text files in directory: " + file_name);
+    }
+
+    files_sizes.resize(n_files);
+    broadcast(files_sizes.data(), n_files, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+
+    data_starts.assign(1, 0);
+    for (size_t size : files_sizes) {
+        data_starts.push_back(data_starts.back() + size);
+    }
+}
+
+/**
+ * @brief Closes the cipher-text files. Collective.
+ *
+ * The files of all processes are complete once it returns, so that any
+ * process can read them.
+ */
+void PosixBackend::closeData(){
+
+    data_file.reset();
+    data_readers.clear();
+    data_starts.clear();
+    waitForProcesses();
+}
+
+/**
+ * @brief Writes the encryption metadata of the calling process to its
+ * metadata file.
+ *
+ * @param nproc                 Total number of MPI processes writing metadata.
+ * @param rank                  MPI rank of the calling process.
+ * @param CT_local_size         Size of the local cipher-text.
+ * @param CT_global_offset      Offset of the local cipher-text within the global
+ *                              cipher-text.
+ * @param CTmeta_global_size    Total number of files across all processes.
+ * @param CTmeta_local_size     Number of local files.
+ * @param CTmeta_global_offset  Index of the first local file among all files.
+ * @param files_sizes           Size of the cipher-text of each local file.
+ * @param files_offsets         Offset of each local file within the local cipher-text.
+ * @param files_orig_sizes      Plain-text size of each local file.
+ * @param files_compressed_sizes  Number of bytes encrypted for each file, fewer than
+ *                               its plain-text size if it was compressed.
+ * @param files_names           NUL-terminated names of the local files.
+ * @param names_global_size     Ignored: the names are stored per process.
+ * @param names_global_offset   Ignored: the names are stored per process.
+ */
+void PosixBackend::writeMetadata(size_t nproc, size_t rank, size_t CT_local_size,
+                                size_t CT_global_offset, size_t CTmeta_global_size,
+                                size_t CTmeta_local_size, size_t CTmeta_global_offset,
+                                std::vector<size_t> &files_sizes,
+                                std::vector<size_t> &files_offsets,
+                                std::vector<size_t> &files_orig_sizes,
+                                std::vector<size_t> &files_compressed_sizes,
+                                const std::string &files_names, size_t, size_t){
+
+    PosixMetadataHeader header;
+
+    std::memcpy(header.magic, metadata_file_magic, sizeof(header.magic));
+    header.nproc = nproc;
+    header.rank = rank;
+    header.local_size = CT_local_size;
+    header.global_offset = CT_global_offset;
+    header.local_count = CTmeta_local_size;
+    header.first_file = CTmeta_global_offset;
+    header.n_files = CTmeta_global_size;
+    header.names_size = files_names.size();
+
+    std::vector<unsigned char> contents(sizeof(header) +
+                                        CTmeta_local_size * sizeof(PosixFileRecord));
+    std::memcpy(contents.data(), &header, sizeof(header));
+
+    for (size_t i = 0; i < CTmeta_local_size; i++) {
+        PosixFileRecord record = {files_sizes[i], files_offsets[i], files_orig_sizes[i],
+                                files_compressed_sizes[i]};
+        std::memcpy(contents.data() + sizeof(header) + i * sizeof(record), &record,
+                    sizeof(record));
+    }
+
+    contents.insert(contents.end(), files_names.begin(), files_names.end());
+
+    metadata_file->writeContents(contents.data(), contents.size());
+}
+
+/**
+ * @brief Reads the encryption metadata of the calling process from its
+ * metadata file.
+ *
+ * @param step                  Ignored: the file holds a single step.
+ * @param nproc                 Total number of MPI processes reading metadata.
+ * @param rank                  MPI rank of the calling process.
+ * @param CTmeta_global_offset  Index of the first local file among all files.
+ * @param CTmeta_local_size     Number of local files.
+ * @return The metadata of the local cipher-text.
+ *
+ * @throws std::runtime_error if the file was written by a different process
+ *         or the number of names does not match the number of files.
+ */
+ParallelCTMeta PosixBackend::readMetadata(size_t, size_t nproc, size_t rank,
+                                        size_t CTmeta_global_offset, size_t CTmeta_local_size){
+
+    std::filesystem::path file_name = processFile(metadata_directory, rank);
+    PosixMetadata contents = readMetadataFile(*metadata_file, file_name);
+
+    if (contents.header.nproc != nproc || contents.header.rank != rank ||
+        contents.header.first_file != CTmeta_global_offset ||
+        contents.header.local_count != CTmeta_local_size) {
+        throw std::runtime_error("Metadata does not match the processes reading it: " +
+                                file_name.string());
+    }
+
+    ParallelCTMeta metadata;
+    metadata.local_size = contents.header.local_size;
+    metadata.global_offset = contents.header.global_offset;
+
+    for (const PosixFileRecord &file_record : contents.file_records) {
+        metadata.files_sizes.push_back(file_record.size);
+        metadata.files_offsets.push_back(file_record.offset);
+        metadata.files_orig_sizes.push_back(file_record.orig_size);
+        metadata.files_compressed_sizes.push_back(file_record.compressed_size);
+    }
+
+    metadata.files_names = splitNames(contents.names.data(), contents.names.size());
+
+    if (metadata.files_names.size() != CTmeta_local_size) {
+        throw std::runtime_error("File names do not match the local metadata");
+    }
+
+    return metadata;
+}
+
+/**
+ * @brief Writes blocks of the cipher-text to the file of the calling process.
+ * Collective.
+ *
+ * The files only make up the global cipher-text if each process writes a
+ * contiguous range of it, and the ranges follow rank order.
+ *
+ * @param blocks  Blocks written by the calling process, possibly none.
+ * @param shape   Size of the global cipher-text across all processes.
+ *
+ * @throws std::runtime_error if the blocks are not contiguous, do not follow
+ *         those of lower ranks, or lie beyond the global cipher-text.
+ */
+void PosixBackend::writeData(const std::vector<DataBlock> &blocks, size_t shape){
+
+    size_t local_bytes = 0;
+    size_t first_start = 0;
+
+    for (const DataBlock &block : blocks) {
+        if (block.count == 0) {
+            continue;
+        }
+        if (local_bytes == 0) {
+            first_start = block.start;
+        }
+        else if (block.start != first_start + local_bytes) {
+            throw std::runtime_error("Blocks written to a file per process must be contiguous");
+        }
+        local_bytes += block.count;
+    }
+
+    if (first_start + local_bytes > shape) {
+        throw std::runtime_error("Block beyond the end of the cipher-text of directory: " +
+                                data_directory.string());
+    }
+
+    size_t expected_start = 0;
+    exclusive_scan(&local_bytes, &expected_start, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        expected_start = 0;
+    }
+
+    if (local_bytes > 0 && first_start != expected_start) {
+        throw std::runtime_error("Blocks written to a file per process must follow rank order");
+    }
+
+    data_file->reserve(local_bytes);
+
+    for (const DataBlock &block : blocks) {
+        data_file->append(block.data, block.count);
+    }
+
+    data_file->finish();
+}
+
+/**
+ * @brief Reads a range of the global cipher-text from the files it spans.
+ *
+ * @param data   Pointer to a buffer of at least count bytes.
+ * @param count  Size of the range.
+ * @param start  Offset of the range within the global cipher-text.
+ *
+ * @throws std::runtime_error if the range lies beyond the global cipher-text.
+ */
+void PosixBackend::readRange(unsigned char *data, size_t count, size_t start){
+
+    if (start + count > data_starts.back()) {
+        throw std::runtime_error("Range beyond the end of the cipher-text of directory: " +
+                                data_directory.string());
+    }
+
+    /* First file ending after start */
+    size_t process = std::upper_bound(data_starts.begin(), data_starts.end(), start) -
+                    data_starts.begin() - 1;
+
+    while (count > 0) {
+
+        size_t offset = start - data_starts[process];
+        size_t piece = std::min(count, data_starts[process + 1] - start);
+
+        if (piece > 0) {
+            std::unique_ptr<AlignedFile> &reader = data_readers[process];
+
+            if (!reader) {
+                reader = std::make_unique<AlignedFile>(processFile(data_directory, process),
+                                                    false, direct, pool);
+            }
+            reader->read(data, piece, offset);
+        }
+
+        data += piece;
+        start += piece;
+        count -= piece;
+        process++;
+    }
+}
+
+/**
+ * @brief Reads the local cipher-text from the cipher-text files.
+ *
+ * @param step   Ignored: the files hold a single step.
+ * @param count  Size of the local cipher-text.
+ * @param start  Offset of the local cipher-text within the global cipher-text.
+ * @return The local cipher-text.
+ */
+std::vector<uint8_t> PosixBackend::readData(size_t, size_t count, size_t start){
+
+    std::vector<uint8_t> buffer(count);
+    readRange(buffer.data(), count, start);
+
+    return buffer;
+}
+
+/**
+ * @brief Writes the cipher-text to the file of the calling process one buffer
+ * at a time, as it is encrypted by another thread. Collective.
+ *
+ * @param full_buffers  Queue of encrypted buffers, in cipher-text order.
+ *                      The producer closes it after the last buffer.
+ * @param free_buffers  Queue receiving the buffers once written.
+ * @param file_name     Path to the cipher-text directory.
+ * @param shape         Size of the global cipher-text across all processes.
+ * @param count         Size of the local cipher-text.
+ * @param start         Offset of the local cipher-text within the global
+ *                      cipher-text.
+ * @param n_rounds      Maximum number of buffers across all processes.
+ *
+ * @throws std::runtime_error if the buffers received do not add up to count bytes.
+ */
+void PosixBackend::streamWriteData(BoundedQueue<std::vector<uint8_t>> &full_buffers,
+                                BoundedQueue<std::vector<uint8_t>> &free_buffers,
+                                const std::string file_name, size_t shape, size_t count,
+                                size_t start, size_t n_rounds){
+
+    if (start + count > shape) {
+        throw std::runtime_error("Cipher-text beyond the end of the global cipher-text");
+    }
+
+    openData(file_name, true);
+    data_file->reserve(count);
+
+    size_t written = 0;
+
+    for (size_t round = 0; round < n_rounds; round++) {
+
+        std::optional<std::vector<uint8_t>> buffer = full_buffers.pop();
+
+        if (buffer) {
+            data_file->append(buffer->data(), buffer->size());
+            written += buffer->size();
+            free_buffers.push(std::move(*buffer));
+        }
+    }
+
+    data_file->finish();
+    closeData();
+
+    if (written != count) {
+        throw std::runtime_error("Streamed cipher-text does not match the expected size");
+    }
+}
+
+/**
+ * @brief Reads the whole encryption metadata. Every calling process reads
+ * the metadata files of all processes.
+ *
+ * @param file_name  Path to the metadata directory.
+ * @return The metadata of all files, in file order.
+ *
+ * @throws std::runtime_error if a file cannot be read, the files do not
+ *         belong together, or the number of names does not match the number
+ *         of files.
+ */
+GlobalCTMeta PosixBackend::readGlobalMetadata(const std::string file_name){
+
+    GlobalCTMeta metadata;
+    std::vector<char> names;
+    size_t nproc = 1;
+
+    /* The number of files is known once the first is read */
+    for (size_t process = 0; process < nproc; process++) {
+
+        std::filesystem::path process_file_name = processFile(file_name, process);
+        AlignedFile file(process_file_name, false, direct, pool);
+        PosixMetadata contents = readMetadataFile(file, process_file_name);
+
+        if (process == 0) {
+            nproc = contents.header.nproc;
+        }
+
+        if (contents.header.nproc != nproc || contents.header.rank != process ||
+            contents.header.first_file != metadata.files_sizes.size()) {
+            throw std::runtime_error("Metadata files do not belong together: " + file_name);
+        }
+
+        metadata.local_sizes.push_back(contents.header.local_size);
+        metadata.global_offsets.push_back(contents.header.global_offset);
+        metadata.local_counts.push_back(contents.header.local_count);
+
+        for (const PosixFileRecord &record : contents.file_records) {
+            metadata.files_sizes.push_back(record.size);
+            metadata.files_offsets.push_back(record.offset);
+            metadata.files_orig_sizes.push_back(record.orig_size);
+            metadata.files_compressed_sizes.push_back(record.compressed_size);
+        }
+
+        names.insert(names.end(), contents.names.begin(), contents.names.end());
+    }
+
+    metadata.files_names = splitNames(names.data(), names.size());
+
+    if (metadata.files_names.size() != metadata.files_sizes.size()) {
+        throw std::runtime_error("File names do not match the metadata of " + file_name);
+    }
+
+    return metadata;
+}
+
+/**
+ * @brief Reads ranges of the cipher-text from the cipher-text files. Collective.
+ *
+ * @param file_name  Path to the cipher-text directory.
+ * @param starts     Offset of each range within the global cipher-text.
+ * @param counts     Size of each range.
+ * @return The bytes of each range.
+ */
+std::vector<std::vector<uint8_t>> PosixBackend::readDataRanges(const std::string file_name,
+                                                const std::vector<size_t> &starts,
+                                                const std::vector<size_t> &counts){
+
+    std::vector<std::vector<uint8_t>> buffers(starts.size());
+
+    openData(file_name, false);
+
+    for (size_t r = 0; r < starts.size(); r++) {
+        buffers[r].resize(counts[r]);
+        readRange(buffers[r].data(), counts[r], starts[r]);
+    }
+
+    closeData();
+
+    return buffers;
+}
@@ -0,0 +1,212 @@
+/**
+* @file ThreadPool.cpp
+* @brief This module provides the implementation of the ThreadPool class.
+* @author Iole Bolognesi
+*
+* The calling thread takes part in every parallel loop as worker 0, so a
+* pool of n threads only spawns n-1 background threads. The iterations of a
+* loop are first split into one contiguous range per worker. Each worker runs
+* its own range from the front and, once it is empty, steals the back half of
+* the range of another worker, so that iterations of uneven cost (e.g. files
+* of different sizes) keep all threads busy while each worker mostly runs
+* neighbouring iterations.
+*/
+
+#include "ThreadPool.hpp"
+
+/**
+ * @brief Constructs a ThreadPool and starts its background workers.
+ *
+ * @param n_threads  Total number of threads, including the calling thread.
+ *                   A value of 0 is treated as 1.
+ */
+ThreadPool::ThreadPool(unsigned int n_threads) 
+    : n_workers(n_threads == 0 ? 1 : n_threads), 
+      ranges(std::make_unique<WorkRange[]>(n_workers)) {
+
+    for (unsigned int worker_id = 1; worker_id < n_workers; worker_id++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, worker_id);
+    }
+}
+
+/**
+ * @brief Stops and joins all background workers.
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake_workers.notify_all();
+
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Runs task(i, worker_id) for every i in [0, n_tasks) across the pool.
+ *
+ * The call blocks until all iterations have completed. If any iteration
+ * throws, the first exception is rethrown in the calling thread once the
+ * loop has drained.
+ *
+ * @param n_tasks  Number of loop iterations.
+ * @param task     Loop body.
+ */
+void ThreadPool::parallelFor(size_t n_tasks, const Task &task) {
+
+    if (n_tasks == 0) {
+        return;
+    }
+
+    /* Nothing to share: run on the calling thread */
+    if (n_workers == 1 || n_tasks == 1) {
+        for (size_t i = 0; i < n_tasks; i++) {
+            task(i, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current_task = &task;
+        error = nullptr;
+
+        for (unsigned int worker_id = 0; worker_id < n_workers; worker_id++) {
+            std::lock_guard<std::mutex> range_lock(ranges[worker_id].mutex);
+            ranges[worker_id].front = n_tasks * worker_id / n_workers;
+            ranges[worker_id].back = n_tasks * (worker_id + 1) / n_workers;
+        }
+
+        busy_workers = n_workers - 1;
+        generation++;
+    }
+    wake_workers.notify_all();
+
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    job_done.wait(lock, [this] { return busy_workers == 0; });
+    current_task = nullptr;
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * @brief Main loop of a background worker: waits for a new parallel loop,
+ * takes part in it, and signals completion.
+ *
+ * @param worker_id  Id of the worker, in [1, size()).
+ */
+void ThreadPool::workerLoop(unsigned int worker_id) {
+
+    size_t seen_generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake_workers.wait(lock, [&] { return stopping || generation != seen_generation; });
+            if (stopping) {
+                return;
+            }
+            seen_generation = generation;
+        }
+
+        runTasks(worker_id);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy_workers == 0) {
+            job_done.notify_one();
+        }
+    }
+}
+
+/**
+ * @brief Runs loop iterations until none are left, first from the range of
+ * the worker and then from the ranges of the others.
+ *
+ * @param worker_id  Id of the calling worker.
+ */
+void ThreadPool::runTasks(unsigned int worker_id) {
+
+    size_t task_index;
+
+    while (true) {
+        if (!takeTask(worker_id, task_index)) {
+            if (!stealTasks(worker_id)) {
+                return;
+            }
+            continue;
+        }
+
+        try {
+            (*current_task)(task_index, worker_id);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Takes the next iteration from the front of the range of a worker.
+ *
+ * @param worker_id   Id of the calling worker.
+ * @param task_index  Set to the index of the iteration taken.
+ * @return true if an iteration was taken; false if the range is empty.
+ */
+bool ThreadPool::takeTask(unsigned int worker_id, size_t &task_index) {
+
+    WorkRange &range = ranges[worker_id];
+    std::lock_guard<std::mutex> lock(range.mutex);
+
+    if (range.front == range.back) {
+        return false;
+    }
+    task_index = range.front++;
+    return true;
+}
+
+/**
+ * @brief Moves the back half of the range of another worker into the 
+ * (empty) range of the calling worker.
+ *
+ * Victims are visited in order starting from the next worker id. Since 
+ * iterations are only ever moved between ranges, a worker that finds all 
+ * ranges empty can stop: any iteration being moved is run by its thief.
+ *
+ * @param worker_id  Id of the calling worker.
+ * @return true if iterations were stolen; false if all ranges are empty.
+ */
+bool ThreadPool::stealTasks(unsigned int worker_id) {
+
+    for (unsigned int offset = 1; offset < n_workers; offset++) {
+
+        WorkRange &victim = ranges[(worker_id + offset) % n_workers];
+        size_t stolen_front, stolen_back;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+
+            size_t remaining = victim.back - victim.front;
+            if (remaining == 0) {
+                continue;
+            }
+            stolen_back = victim.back;
+            stolen_front = victim.back - (remaining + 1) / 2;
+            victim.back = stolen_front;
+        }
+
+        WorkRange &range = ranges[worker_id];
+        std::lock_guard<std::mutex> lock(range.mutex);
+        range.front = stolen_front;
+        range.back = stolen_back;
+        return true;
+    }
+    return false;
+}
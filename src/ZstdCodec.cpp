@@ -0,0 +1,94 @@
+/**
+* @file ZstdCodec.cpp
+* @brief This module provides the implementation of the ZstdCodec class.
+* @author Iole Bolognesi
+*
+* Every thread keeps its own compression and decompression contexts, so
+* that files compressed by the threads of a pool do not allocate a context
+* each.
+*/
+
+#ifdef USE_ZSTD
+
+#include "ZstdCodec.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <zstd.h>
+
+/**
+ * @brief Constructs a ZstdCodec.
+ *
+ * @param level  Compression level, from 1 (fastest) to ZSTD_maxCLevel();
+ *               0 selects the default level of the library.
+ */
+ZstdCodec::ZstdCodec(int level) : level(level) {
+
+    if (level < 0 || level > ZSTD_maxCLevel()) {
+        throw std::runtime_error("Invalid zstd compression level: " + std::to_string(level));
+    }
+}
+
+/**
+ * @brief Returns the largest size that length bytes can compress to.
+ */
+size_t ZstdCodec::maxCompressedSize(size_t length){
+
+    return ZSTD_compressBound(length);
+}
+
+/**
+ * @brief Compresses a buffer into a single frame.
+ *
+ * @param output    Pointer to a buffer of capacity bytes.
+ * @param capacity  Size of the output buffer, at least maxCompressedSize(length).
+ * @param input     Pointer to the bytes to compress.
+ * @param length    Number of bytes to compress.
+ * @return The size of the frame.
+ *
+ * @throws std::runtime_error if the compression fails.
+ */
+size_t ZstdCodec::compress(unsigned char *output, size_t capacity,
+                        const unsigned char *input, size_t length){
+
+    thread_local std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context(
+                                            ZSTD_createCCtx(), ZSTD_freeCCtx);
+
+    size_t result = ZSTD_compressCCtx(context.get(), output, capacity, input, length, level);
+
+    if (ZSTD_isError(result)) {
+        throw std::runtime_error(std::string("zstd compression failed: ") +
+                                ZSTD_getErrorName(result));
+    }
+    return result;
+}
+
+/**
+ * @brief Decompresses a frame.
+ *
+ * @param output             Pointer to a buffer of length bytes.
+ * @param length             Size of the original bytes.
+ * @param input              Pointer to the frame.
+ * @param compressed_length  Size of the frame.
+ *
+ * @throws std::runtime_error if the frame is corrupt or does not hold
+ *         length bytes.
+ */
+void ZstdCodec::decompress(unsigned char *output, size_t length,
+                        const unsigned char *input, size_t compressed_length){
+
+    thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context(
+                                            ZSTD_createDCtx(), ZSTD_freeDCtx);
+
+    size_t result = ZSTD_decompressDCtx(context.get(), output, length, input,
+                                        compressed_length);
+
+    if (ZSTD_isError(result)) {
+        throw std::runtime_error(std::string("zstd decompression failed: ") +
+                                ZSTD_getErrorName(result));
+    }
+    if (result != length) {
+        throw std::runtime_error("Decompressed size does not match the original size");
+    }
+}
+#endif
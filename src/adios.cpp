@@ -4,19 +4,137 @@
 * @author Iole Bolognesi 
 * 
 * This module provides utility functions for reading and writing 
-* to a file in parallel using the ADIOS 2 framework. 
+* to a file in parallel using the ADIOS 2 framework. Each function writing 
+* or reading a whole file has a counterpart working on one step of an 
+* engine that the caller keeps open, so that repeated writes and reads 
+* can be measured without the cost of opening and closing the file. 
+* IO objects have fixed names and are reused.
 *
 */
 
+#include <stdexcept>
+
 #include "adios.hpp"
 #include "libpar.hpp"
 
+/**
+ * @brief Splits a packed table of NUL-terminated names.
+ *
+ * @param names  Names, each followed by a NUL character.
+ * @return The names, in table order.
+ */
+static std::vector<std::string> splitNames(const std::vector<char> &names){
+
+        std::vector<std::string> split;
+        size_t start = 0;
+
+        for (size_t end = 0; end < names.size(); end++) {
+            if (names[end] == '\0') {
+                split.emplace_back(names.data() + start, end - start);
+                start = end + 1;
+            }
+        }
+
+        return split;
+}
+
+/**
+ * @brief Returns the IO of the given name, declaring it on first use.
+ *
+ * Reusing IO objects keeps the registry of the ADIOS object bounded when
+ * the same file is written or read repeatedly.
+ *
+ * @param adios    Reference to the ADIOS2 context object.
+ * @param io_name  Name of the IO.
+ * @return The IO object.
+ */
+adios2::IO declareOrAtIO(adios2::ADIOS &adios, const std::string io_name){
+
+        try {
+            return adios.AtIO(io_name);
+        }
+        catch (std::invalid_argument &) {
+            return adios.DeclareIO(io_name);
+        }
+}
+
+/**
+ * @brief Opens an engine on a file, through the IO of the given name.
+ *
+ * The engine can be kept open across iterations, each one writing or 
+ * reading a step.
+ *
+ * @param adios      Reference to the ADIOS2 context object.
+ * @param io_name    Name of the IO.
+ * @param file_name  Name of the ADIOS2 file.
+ * @param mode       adios2::Mode::Write, or adios2::Mode::ReadRandomAccess 
+ *                   to read any step.
+ * @return The IO and the open engine.
+ */
+AdiosStream openStream(adios2::ADIOS &adios, const std::string io_name,
+                    const std::string file_name, adios2::Mode mode){
+
+        AdiosStream stream;
+        stream.io = declareOrAtIO(adios, io_name);
+        stream.engine = stream.io.Open(file_name, mode);
+        return stream;
+}
+
+/**
+ * @brief Defines a global array variable, or updates its dimensions if 
+ * the IO already holds it.
+ *
+ * @param io     IO object holding the variable.
+ * @param name   Name of the variable.
+ * @param shape  Global dimensions.
+ * @param start  Offset of the local block.
+ * @param count  Dimensions of the local block.
+ * @return The variable.
+ */
+template <class T>
+static adios2::Variable<T> defineVariable(adios2::IO &io, const std::string &name,
+                                        const adios2::Dims &shape, const adios2::Dims &start,
+                                        const adios2::Dims &count){
+
+        adios2::Variable<T> variable = io.InquireVariable<T>(name);
+
+        if (!variable) {
+            return io.DefineVariable<T>(name, shape, start, count);
+        }
+
+        variable.SetShape(shape);
+        variable.SetSelection({start, count});
+        return variable;
+}
+
+/**
+ * @brief Looks up a variable to be read from a step of a random-access engine.
+ *
+ * @param io    IO object of the reader.
+ * @param name  Name of the variable.
+ * @param step  Step to read from.
+ * @return The variable, with the step selected.
+ *
+ * @throws std::runtime_error if the variable is not found.
+ */
+template <class T>
+static adios2::Variable<T> inquireVariable(adios2::IO &io, const std::string &name, size_t step){
+
+        adios2::Variable<T> variable = io.InquireVariable<T>(name);
+
+        if (!variable) {
+            throw std::runtime_error("Variable not found by adios2 reader: " + name);
+        }
+
+        variable.SetStepSelection({step, 1});
+        return variable;
+}
+
 /**
  * @brief Writes encryption metadata in parallel using ADIOS 2.
  *
- * This function writes encryption metadata in parallel to an ADIOS 2 file. 
- * The function stores 4 global ADIOS 2 variables: "local_sizes", "global_offsets", 
- * "files_sizes", and "files_offsets".
+ * This function writes encryption metadata in parallel to an ADIOS 2 file,
+ * as the single step of a new file (see writeMetadataStep).
  *
  * @param adios                 Reference to the ADIOS2 context object.
  * @param nproc                 Total number of MPI processes writing metadata.
@@ -34,8 +152,14 @@
                                 contained in the local cipher-text.
  * @param files_offsets         Vector containing offsets of each file cipher-text
                                 contained in the local cipher-text. 
+ * @param files_orig_sizes      Vector containing the plain-text size of each file.
+ * @param files_compressed_sizes  Number of bytes encrypted for each file, fewer than
+ *                               its plain-text size if it was compressed.
+ * @param files_names           NUL-terminated names of the local files.
+ * @param names_global_size     Size in bytes of the names of all files.
+ * @param names_global_offset   Offset of where the local names fit within the 
+ *                              names of all files.
  * @param file_name             Name of the ADIOS2 output file.
- * @param iter_id               Iteration id for repeated write operations
  */
 void parallelWriteMetadata(adios2::ADIOS &adios, size_t nproc, size_t rank,
                         size_t count, size_t CT_local_size, size_t CT_global_offset,
@@ -43,42 +167,103 @@ void parallelWriteMetadata(adios2::ADIOS &adios, size_t nproc, size_t rank,
                         size_t CTmeta_local_size, size_t CTmeta_global_offset, 
                         std::vector<size_t> &files_sizes,
                         std::vector<size_t> &files_offsets,
-                        const std::string file_name, std::string iter_id){
-        
-        std::string writer_name = "MetadataWriter" + iter_id;
-   
-        adios2::IO io = adios.DeclareIO(writer_name);
+                        std::vector<size_t> &files_orig_sizes,
+                        std::vector<size_t> &files_compressed_sizes,
+                        const std::string &files_names, size_t names_global_size,
+                        size_t names_global_offset, const std::string file_name){
 
+        AdiosStream stream = openStream(adios, "MetadataWriter", file_name, adios2::Mode::Write);
+
+        writeMetadataStep(stream, nproc, rank, count, CT_local_size, CT_global_offset,
+                        CTmeta_global_size, CTmeta_local_size, CTmeta_global_offset,
+                        files_sizes, files_offsets, files_orig_sizes, files_compressed_sizes,
+                        files_names, names_global_size, names_global_offset);
+
+        stream.engine.Close();
+}
+
+/**
+ * @brief Writes encryption metadata in parallel as one step of an open engine.
+ *
+ * The step holds 10 global ADIOS 2 variables: "local_sizes", "global_offsets", 
+ * "local_counts", "names_sizes", "names_offsets", "files_sizes", "files_offsets", 
+ * "files_orig_sizes", "files_compressed_sizes", and "files_names". The last one is a packed table of 
+ * NUL-terminated file names, in file order, of which each process writes the
+ * names_sizes bytes starting at names_offsets. With the names and the original
+ * sizes, the files can be restored without access to the dataset directory.
+ *
+ * @param stream  IO and engine open for writing. Other parameters are as 
+ *                for parallelWriteMetadata.
+ */
+void writeMetadataStep(AdiosStream &stream, size_t nproc, size_t rank,
+                        size_t count, size_t CT_local_size, size_t CT_global_offset,
+                        size_t CTmeta_global_size, 
+                        size_t CTmeta_local_size, size_t CTmeta_global_offset, 
+                        std::vector<size_t> &files_sizes,
+                        std::vector<size_t> &files_offsets,
+                        std::vector<size_t> &files_orig_sizes,
+                        std::vector<size_t> &files_compressed_sizes,
+                        const std::string &files_names, size_t names_global_size,
+                        size_t names_global_offset){
+        
+        adios2::IO &io = stream.io;
+        adios2::Engine &writer = stream.engine;
+        size_t names_local_size = files_names.size();
 
-        auto var_CT_sizes = io.DefineVariable<size_t>("local_sizes",
+        auto var_CT_sizes = defineVariable<size_t>(io, "local_sizes",
                                             {nproc}, {rank}, {count});
        
-        auto var_CT_offsets = io.DefineVariable<size_t>("global_offsets",
+        auto var_CT_offsets = defineVariable<size_t>(io, "global_offsets",
+                                            {nproc}, {rank}, {count});
+
+        auto var_CT_counts = defineVariable<size_t>(io, "local_counts",
+                                            {nproc}, {rank}, {count});
+
+        auto var_names_sizes = defineVariable<size_t>(io, "names_sizes",
+                                            {nproc}, {rank}, {count});
+
+        auto var_names_offsets = defineVariable<size_t>(io, "names_offsets",
                                             {nproc}, {rank}, {count});
        
-        auto var_files_sizes = io.DefineVariable<size_t>("files_sizes",
+        auto var_files_sizes = defineVariable<size_t>(io, "files_sizes",
                             {CTmeta_global_size}, {CTmeta_global_offset}, {CTmeta_local_size});
                
-        auto var_files_offsets = io.DefineVariable<size_t>("files_offsets",
+        auto var_files_offsets = defineVariable<size_t>(io, "files_offsets",
                             {CTmeta_global_size}, {CTmeta_global_offset}, {CTmeta_local_size});
 
+        auto var_files_orig_sizes = defineVariable<size_t>(io, "files_orig_sizes",
+                            {CTmeta_global_size}, {CTmeta_global_offset}, {CTmeta_local_size});
+
+        auto var_files_compressed_sizes = defineVariable<size_t>(io, "files_compressed_sizes",
+                            {CTmeta_global_size}, {CTmeta_global_offset}, {CTmeta_local_size});
+
+        auto var_files_names = defineVariable<char>(io, "files_names",
+                            {names_global_size}, {names_global_offset}, {files_names.size()});
+
 
-        adios2::Engine writer = io.Open(file_name, adios2::Mode::Write);
         writer.BeginStep();
         writer.Put(var_CT_sizes, &CT_local_size);
         writer.Put(var_CT_offsets, &CT_global_offset);
-        writer.Put(var_files_sizes, files_sizes.data());
-        writer.Put(var_files_offsets, files_offsets.data());
+        writer.Put(var_CT_counts, &CTmeta_local_size);
+        writer.Put(var_names_sizes, &names_local_size);
+        writer.Put(var_names_offsets, &names_global_offset);
+        /* Processes with no files (possible with byte-balanced 
+        partitioning) contribute no block */
+        if (CTmeta_local_size > 0) {
+            writer.Put(var_files_sizes, files_sizes.data());
+            writer.Put(var_files_offsets, files_offsets.data());
+            writer.Put(var_files_orig_sizes, files_orig_sizes.data());
+            writer.Put(var_files_compressed_sizes, files_compressed_sizes.data());
+            writer.Put(var_files_names, files_names.data());
+        }
         writer.EndStep();
-        writer.Close();
 }
 
 /**
  * @brief Reads encryption metadata in parallel using ADIOS 2.
  *
- * This function reads encryption metadata in parallel from an ADIOS 2 file. 
- * The function retrieves 4 global ADIOS 2 variables: "local_sizes", "global_offsets", 
- * "files_sizes", and "files_offsets".
+ * This function reads the encryption metadata of the calling process from
+ * the first step of an ADIOS 2 file (see readMetadataStep).
  *
  * @param adios                 Reference to the ADIOS2 context object.
  * @param file_name             Name of the ADIOS2 file to be read.
@@ -89,118 +274,419 @@ void parallelWriteMetadata(adios2::ADIOS &adios, size_t nproc, size_t rank,
  * @param CTmeta_global_offset  Offset of where the local metadata fits within the global 
  *                              metadata. 
  * @param CTmeta_local_size     Number of local metadata entries.
- * @param iter_id               Iteration id for repeated read operations
  */
 ParallelCTMeta parallelReadMetadata(adios2::ADIOS &adios, const std::string file_name,
                                 size_t nproc, size_t rank, size_t count,
-                                size_t CTmeta_global_offset, size_t CTmeta_local_size,
-                                std::string iter_id){
+                                size_t CTmeta_global_offset, size_t CTmeta_local_size){
+
+        AdiosStream stream = openStream(adios, "MetadataReader", file_name, 
+                                        adios2::Mode::ReadRandomAccess);
+
+        ParallelCTMeta metadata = readMetadataStep(stream, 0, nproc, rank, count,
+                                                CTmeta_global_offset, CTmeta_local_size);
+
+        stream.engine.Close();
+
+        return metadata;
+}
+
+/**
+ * @brief Reads encryption metadata in parallel from one step of an open engine.
+ *
+ * The function retrieves the local blocks of the global ADIOS 2 variables 
+ * "local_sizes", "global_offsets", "files_sizes", "files_offsets", 
+ * "files_orig_sizes", "files_compressed_sizes", and "files_names", the 
+ * latter located through
+ * "names_sizes" and "names_offsets".
+ *
+ * @param stream  IO and engine open for random-access reading.
+ * @param step    Step to read. Other parameters are as for parallelReadMetadata.
+ *
+ * @throws std::runtime_error if a variable is missing or the number of names 
+ *         does not match the number of local files.
+ */
+ParallelCTMeta readMetadataStep(AdiosStream &stream, size_t step, 
+                                size_t nproc, size_t rank, size_t count,
+                                size_t CTmeta_global_offset, size_t CTmeta_local_size){
        
+        adios2::IO &io = stream.io;
+        adios2::Engine &reader = stream.engine;
+
         ParallelCTMeta metadata;
         metadata.files_sizes.resize(CTmeta_local_size);
         metadata.files_offsets.resize(CTmeta_local_size);
+        metadata.files_orig_sizes.resize(CTmeta_local_size);
+        metadata.files_compressed_sizes.resize(CTmeta_local_size);
 
-        std::string reader_name = "MetadataReader" + iter_id;
-   
-        adios2::IO io = adios.DeclareIO(reader_name);
-        adios2::Engine reader = io.Open(file_name, adios2::Mode::Read);
-
-        reader.BeginStep();
-
-        auto var_CT_size = io.InquireVariable<size_t>("local_sizes");
+        auto var_CT_size = inquireVariable<size_t>(io, "local_sizes", step);
         var_CT_size.SetSelection({{rank}, {count}});
         reader.Get(var_CT_size, &metadata.local_size);
 
-        auto var_CT_offset = io.InquireVariable<size_t>("global_offsets");
+        auto var_CT_offset = inquireVariable<size_t>(io, "global_offsets", step);
         var_CT_offset.SetSelection({{rank}, {count}});
         reader.Get(var_CT_offset, &metadata.global_offset);
 
-        auto var_files_sizes = io.InquireVariable<size_t>("files_sizes");
-        var_files_sizes.SetSelection({{CTmeta_global_offset}, {CTmeta_local_size}});
-        reader.Get(var_files_sizes, metadata.files_sizes.data());
-        
-        auto var_files_offsets = io.InquireVariable<size_t>("files_offsets");
-        var_files_offsets.SetSelection({{CTmeta_global_offset}, {CTmeta_local_size}});
-        reader.Get(var_files_offsets, metadata.files_offsets.data());
+        if (CTmeta_local_size > 0) {
+            auto var_files_sizes = inquireVariable<size_t>(io, "files_sizes", step);
+            var_files_sizes.SetSelection({{CTmeta_global_offset}, {CTmeta_local_size}});
+            reader.Get(var_files_sizes, metadata.files_sizes.data());
+            
+            auto var_files_offsets = inquireVariable<size_t>(io, "files_offsets", step);
+            var_files_offsets.SetSelection({{CTmeta_global_offset}, {CTmeta_local_size}});
+            reader.Get(var_files_offsets, metadata.files_offsets.data());
+
+            auto var_files_orig_sizes = inquireVariable<size_t>(io, "files_orig_sizes", step);
+            var_files_orig_sizes.SetSelection({{CTmeta_global_offset}, {CTmeta_local_size}});
+            reader.Get(var_files_orig_sizes, metadata.files_orig_sizes.data());
+
+            auto var_files_compressed_sizes = inquireVariable<size_t>(io, "files_compressed_sizes",
+                                                                    step);
+            var_files_compressed_sizes.SetSelection({{CTmeta_global_offset}, {CTmeta_local_size}});
+            reader.Get(var_files_compressed_sizes, metadata.files_compressed_sizes.data());
+        }
+
+        /* The extent of the local names is needed before they can be read */
+        size_t names_local_size;
+        size_t names_global_offset;
+
+        auto var_names_size = inquireVariable<size_t>(io, "names_sizes", step);
+        var_names_size.SetSelection({{rank}, {count}});
+        reader.Get(var_names_size, &names_local_size, adios2::Mode::Sync);
+
+        auto var_names_offset = inquireVariable<size_t>(io, "names_offsets", step);
+        var_names_offset.SetSelection({{rank}, {count}});
+        reader.Get(var_names_offset, &names_global_offset, adios2::Mode::Sync);
+
+        std::vector<char> names(names_local_size);
+
+        if (names_local_size > 0) {
+            auto var_files_names = inquireVariable<char>(io, "files_names", step);
+            var_files_names.SetSelection({{names_global_offset}, {names_local_size}});
+            reader.Get(var_files_names, names.data());
+        }
                                 
+        reader.PerformGets();
+
+        metadata.files_names = splitNames(names);
+
+        if (metadata.files_names.size() != CTmeta_local_size) {
+            throw std::runtime_error("File names do not match the local metadata");
+        }
+
+        return metadata;
+}
+
+/**
+ * @brief Reads the whole encryption metadata using ADIOS 2.
+ *
+ * Every calling process reads the metadata written by all processes, 
+ * including the table of file names, e.g. to look up files by name. 
+ *
+ * @param adios                 Reference to the ADIOS2 context object.
+ * @param file_name             Name of the ADIOS2 file to be read.
+ * @return The metadata of all files, in file order.
+ *
+ * @throws std::runtime_error if a variable is missing or the number of 
+ *         names does not match the number of files.
+ */
+GlobalCTMeta readGlobalMetadata(adios2::ADIOS &adios, const std::string file_name){
+
+        GlobalCTMeta metadata;
+
+        adios2::IO io = declareOrAtIO(adios, "GlobalMetadataReader");
+        adios2::Engine reader = io.Open(file_name, adios2::Mode::Read);
+
+        reader.BeginStep();
+
+        auto readAll = [&](auto variable, auto &values){
+            if (!variable) {
+                throw std::runtime_error("Variable not found by adios2 reader");
+            }
+            values.resize(variable.Shape()[0]);
+            if (!values.empty()) {
+                reader.Get(variable, values.data());
+            }
+        };
+
+        std::vector<char> names;
+
+        readAll(io.InquireVariable<size_t>("local_sizes"), metadata.local_sizes);
+        readAll(io.InquireVariable<size_t>("global_offsets"), metadata.global_offsets);
+        readAll(io.InquireVariable<size_t>("local_counts"), metadata.local_counts);
+        readAll(io.InquireVariable<size_t>("files_sizes"), metadata.files_sizes);
+        readAll(io.InquireVariable<size_t>("files_offsets"), metadata.files_offsets);
+        readAll(io.InquireVariable<size_t>("files_orig_sizes"), metadata.files_orig_sizes);
+        readAll(io.InquireVariable<size_t>("files_compressed_sizes"), 
+                metadata.files_compressed_sizes);
+        readAll(io.InquireVariable<char>("files_names"), names);
+
         reader.EndStep();
 
         reader.Close();
 
+        metadata.files_names = splitNames(names);
+
+        if (metadata.files_names.size() != metadata.files_sizes.size()) {
+            throw std::runtime_error("File names do not match the metadata of " + file_name);
+        }
+
         return metadata;
 }
 
  /**
  * @brief Writes a cipher-text (binary data) to a file in parallel using ADIOS2.
  *
- * This function writes a vector of bytes in parallel to an ADIOS 2 file. 
+ * This function writes a buffer of bytes in parallel to an ADIOS 2 file,
+ * as the single step of a new file (see writeDataStep). 
  *
  * @param adios                 Reference to the ADIOS2 context object.
  * @param file_name             Name of the ADIOS2 output file.
- * @param data                  Vector containing binary data.
+ * @param data                  Pointer to the local binary data (count bytes).
  * @param shape                 Size of the global cipher-text across all processes. 
  * @param count                 Size of the local cipher-text.
  * @param start                 Offset of the local cipher-text within the global 
  *                              cipher-text. 
- * @param iter_id               Iteration id for repeated write operations
  */
-void parallelWriteData(adios2::ADIOS &adios, std::vector<uint8_t> &data, 
+void parallelWriteData(adios2::ADIOS &adios, const uint8_t *data, 
                   const std::string file_name, size_t shape, size_t count, 
-                  size_t start, std::string iter_id){
+                  size_t start){
+
+        AdiosStream stream = openStream(adios, "DataWriter", file_name, adios2::Mode::Write);
+
+        writeDataStep(stream, data, shape, count, start);
+
+        stream.engine.Close();
+}
 
-        std::string writer_name = "DataWriter" + iter_id;
-   
-        adios2::IO io = adios.DeclareIO(writer_name);
+ /**
+ * @brief Writes a cipher-text (binary data) in parallel as one step of an 
+ * open engine, in the global "binary_data" variable.
+ *
+ * @param stream  IO and engine open for writing. Other parameters are as 
+ *                for parallelWriteData.
+ */
+void writeDataStep(AdiosStream &stream, const uint8_t *data, 
+                  size_t shape, size_t count, size_t start){
 
-        auto var = io.DefineVariable<uint8_t>("binary_data", {shape}, {start}, {count});
+        writeDataBlocksStep(stream, {{data, start, count}}, shape);
+}
+
+ /**
+ * @brief Writes blocks of a cipher-text (binary data) to a file in parallel
+ * using ADIOS2, as the single step of a new file (see writeDataBlocksStep).
+ *
+ * @param adios                 Reference to the ADIOS2 context object.
+ * @param blocks                Blocks put by the calling process, possibly none.
+ * @param file_name             Name of the ADIOS2 output file.
+ * @param shape                 Size of the global cipher-text across all processes. 
+ */
+void parallelWriteDataBlocks(adios2::ADIOS &adios, const std::vector<DataBlock> &blocks,
+                  const std::string file_name, size_t shape){
+
+        AdiosStream stream = openStream(adios, "DataWriter", file_name, adios2::Mode::Write);
+
+        writeDataBlocksStep(stream, blocks, shape);
+
+        stream.engine.Close();
+}
+
+ /**
+ * @brief Writes blocks of a cipher-text (binary data) in parallel as one 
+ * step of an open engine, in the global "binary_data" variable.
+ *
+ * A process may put the blocks of other processes, e.g. the aggregator of
+ * a node, while the others put none but still take part in the step. The
+ * file is read exactly like one written a block per process.
+ *
+ * @param stream  IO and engine open for writing.
+ * @param blocks  Blocks put by the calling process. Their data must remain 
+ *                valid until the function returns.
+ * @param shape   Size of the global cipher-text across all processes. 
+ */
+void writeDataBlocksStep(AdiosStream &stream, const std::vector<DataBlock> &blocks,
+                  size_t shape){
+
+        auto var = defineVariable<uint8_t>(stream.io, "binary_data", {shape}, {0}, {0});
+
+        stream.engine.BeginStep();
+        for (const DataBlock &block : blocks) {
+            if (block.count > 0) {
+                var.SetSelection({{block.start}, {block.count}});
+                stream.engine.Put(var, block.data);
+            }
+        }
+        stream.engine.EndStep();
+}
+
+
+ /**
+ * @brief Writes a cipher-text (binary data) to a file in parallel using ADIOS2,
+ * one bounded buffer at a time.
+ *
+ * This function writes the local cipher-text as a sequence of buffers produced
+ * by another thread, so that the next buffer can be encrypted while the 
+ * current one is written. The buffers are written as consecutive blocks of the
+ * same global "binary_data" variable within a single step, so the resulting 
+ * file is read exactly like the one written by parallelWriteData. 
+ *
+ * Each round pops one full buffer, puts it in synchronous mode, so that 
+ * ADIOS 2 copies it before Put returns, and asks the engine to write the 
+ * data put so far through PerformDataWrite. The buffer is then returned to 
+ * the producer. Only BP5 writes the data in PerformDataWrite; other engines 
+ * (BP4, HDF5, set in the config file) keep it until EndStep, which is why 
+ * the buffer must not be referenced by a deferred Put. Since the flush may 
+ * be collective, every process runs the same number of rounds; processes
+ * with no buffers left take part without putting data. 
+ *
+ * @param adios                 Reference to the ADIOS2 context object.
+ * @param full_buffers          Queue of encrypted buffers, in cipher-text order.
+ *                              The producer closes it after the last buffer.
+ * @param free_buffers          Queue receiving the buffers once written.
+ * @param file_name             Name of the ADIOS2 output file.
+ * @param shape                 Size of the global cipher-text across all processes. 
+ * @param count                 Size of the local cipher-text.
+ * @param start                 Offset of the local cipher-text within the global 
+ *                              cipher-text. 
+ * @param n_rounds              Maximum number of buffers across all processes.
+ *
+ * @throws std::runtime_error if the buffers received do not add up to count bytes.
+ */
+void parallelStreamWriteData(adios2::ADIOS &adios, 
+                  BoundedQueue<std::vector<uint8_t>> &full_buffers,
+                  BoundedQueue<std::vector<uint8_t>> &free_buffers,
+                  const std::string file_name, size_t shape, size_t count, 
+                  size_t start, size_t n_rounds){
+
+        adios2::IO io = declareOrAtIO(adios, "StreamWriter");
+
+        auto var = defineVariable<uint8_t>(io, "binary_data", {shape}, {start}, {count});
 
         adios2::Engine writer = io.Open(file_name, adios2::Mode::Write);
         writer.BeginStep();
-        writer.Put(var, data.data());
+
+        size_t written = 0;
+
+        for (size_t round = 0; round < n_rounds; round++) {
+
+            std::optional<std::vector<uint8_t>> buffer = full_buffers.pop();
+
+            if (buffer && !buffer->empty()) {
+                var.SetSelection({{start + written}, {buffer->size()}});
+                writer.Put(var, buffer->data(), adios2::Mode::Sync);
+                written += buffer->size();
+            }
+
+            writer.PerformDataWrite();
+
+            if (buffer) {
+                free_buffers.push(std::move(*buffer));
+            }
+        }
+
         writer.EndStep();
         writer.Close();
 
+        if (written != count) {
+            throw std::runtime_error("Streamed cipher-text does not match the expected size");
+        }
 }
 
-
  /**
  * @brief Reads a cipher-text (binary data) from a file in parallel using ADIOS2.
  *
- * This function reads a vector of bytes in parallel from an ADIOS 2 file. 
+ * This function reads a vector of bytes in parallel from the first step of 
+ * an ADIOS 2 file (see readDataStep). 
  *
  * @param adios                 Reference to the ADIOS2 context object.
  * @param file_name             Name of the ADIOS2 file to be read.
  * @param count                 Size of the local cipher-text.
  * @param start                 Offset of the local cipher-text within the global 
  *                              cipher-text. 
- * @param iter_id               Iteration id for repeated read operations
  */
 std::vector<uint8_t> parallelReadData(adios2::ADIOS &adios, const std::string file_name, 
-                                size_t count, size_t start, std::string iter_id) {
+                                size_t count, size_t start) {
 
-        std::string reader_name = "DataReader" + iter_id;
-   
-        adios2::IO io = adios.DeclareIO(reader_name);
-        adios2::Engine reader = io.Open(file_name, adios2::Mode::Read);
+        AdiosStream stream = openStream(adios, "DataReader", file_name, 
+                                        adios2::Mode::ReadRandomAccess);
 
-        reader.BeginStep();
+        std::vector<uint8_t> buffer = readDataStep(stream, 0, count, start);
 
-        auto var = io.InquireVariable<uint8_t>("binary_data");
+        stream.engine.Close();
+
+        return buffer;
+}
+
+ /**
+ * @brief Reads a cipher-text (binary data) in parallel from one step of an 
+ * open engine.
+ *
+ * @param stream  IO and engine open for random-access reading.
+ * @param step    Step to read. Other parameters are as for parallelReadData.
+ *
+ * @throws std::runtime_error if the variable is not found.
+ */
+std::vector<uint8_t> readDataStep(AdiosStream &stream, size_t step, size_t count, size_t start) {
+
+        auto var = inquireVariable<uint8_t>(stream.io, "binary_data", step);
     
         var.SetSelection({{start}, {count}});
         
         std::vector<uint8_t> buffer(count);
 
+        if (count > 0) {
+            stream.engine.Get(var, buffer);
+        }
+
+        stream.engine.PerformGets();
+
+        return buffer;
+}
+
+ /**
+ * @brief Reads ranges of a cipher-text (binary data) from a file using ADIOS2.
+ *
+ * Only the requested bytes are read: each range is a separate selection of
+ * the global "binary_data" variable, and all of them are read in one step.
+ *
+ * @param adios                 Reference to the ADIOS2 context object.
+ * @param file_name             Name of the ADIOS2 file to be read.
+ * @param starts                Offset of each range within the global cipher-text.
+ * @param counts                Size of each range.
+ * @return The bytes of each range.
+ *
+ * @throws std::runtime_error if the variable is not found.
+ */
+std::vector<std::vector<uint8_t>> parallelReadDataRanges(adios2::ADIOS &adios, 
+                                    const std::string file_name,
+                                    const std::vector<size_t> &starts,
+                                    const std::vector<size_t> &counts) {
+
+        adios2::IO io = declareOrAtIO(adios, "RangeReader");
+        adios2::Engine reader = io.Open(file_name, adios2::Mode::Read);
+
+        reader.BeginStep();
+
+        auto var = io.InquireVariable<uint8_t>("binary_data");
+
         if (!var)
         {
             throw std::runtime_error ("Variable not found by adios2 reader");
         }
 
-        reader.Get(var, buffer);
+        std::vector<std::vector<uint8_t>> buffers(starts.size());
+
+        /* Deferred reads keep the selection in place when each was issued */
+        for (size_t i = 0; i < starts.size(); i++) {
+            buffers[i].resize(counts[i]);
+            if (counts[i] > 0) {
+                var.SetSelection({{starts[i]}, {counts[i]}});
+                reader.Get(var, buffers[i].data());
+            }
+        }
 
         reader.EndStep();
         
         reader.Close();
 
-        return buffer;
-}
\ No newline at end of file
+        return buffers;
+}
@@ -0,0 +1,299 @@
+/**
+ * @file extract.cpp
+ * @brief This script decrypts single files out of the cipher-text written
+ * by the parallel pipeline.
+ * @author Iole Bolognesi
+ *
+ * This script looks up files by name or glob pattern in the metadata
+ * written through ADIOS 2 or MPI-IO, reads only the cipher-text of those
+ * files through the same library, and decrypts them with the key and IV of
+ * the process that encrypted them, as saved by the parallel pipeline with
+ * --key-file, protected by a passphrase if --passphrase-file is given.
+ *
+ * Built with -DDECRYPT_ALL (bin/decrypt), it decrypts every file by 
+ * default, so that the read and decryption of a dataset run as their own 
+ * job, e.g. on a different number of nodes than its encryption.
+ *
+ * The matching files are split across the MPI processes by bytes, whatever
+ * the number of processes that encrypted them, e.g. to restore a whole 
+ * dataset ('*') on fewer nodes. Consecutive files encrypted by the same 
+ * process form a run, which is read as a single selection. Each file is 
+ * then decrypted on its own, from the IV derived from its global index.
+ */
+
+#include <fnmatch.h>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <cstdlib>
+#include <algorithm>
+
+#include "libpar.hpp"
+#include "IOBackendFactory.hpp"
+#include "CodecFactory.hpp"
+#include "fileIO.hpp"
+#include "keyFile.hpp"
+#include "parsing.hpp"
+#include "cryptography.hpp"
+#include "CipherFactory.hpp"
+#include "Cipher.hpp"
+#include "FileDecryptor.hpp"
+
+using namespace CryptoPP;
+
+#ifdef DECRYPT_ALL
+static const char *usage = "Usage : mpirun -n <number> ./bin/decrypt <ALGORITHM_MODE> "
+                        "<key file> [file name or pattern]... [options]";
+#else
+static const char *usage = "Usage : mpirun -n <number> ./bin/extract <ALGORITHM_MODE> "
+                        "<key file> <file name or pattern>... [options]";
+#endif
+
+/* Consecutive files [first, last) of the cipher-text of one process */
+struct FileRun {
+    size_t first;
+    size_t last;
+    size_t writer;
+};
+
+/**
+ * @brief Groups a list of files into runs of consecutive files encrypted 
+ * by the same process.
+ *
+ * @param files          Indices of the files, in increasing order.
+ * @param files_writers  Rank of the process that encrypted each file.
+ * @return The runs covering the files, in order.
+ */
+static std::vector<FileRun> groupRuns(const std::vector<size_t> &files,
+                                    const std::vector<size_t> &files_writers){
+
+    std::vector<FileRun> runs;
+
+    for(size_t i : files){
+        if(!runs.empty() && runs.back().last == i && runs.back().writer == files_writers[i]){
+            runs.back().last++;
+        }
+        else{
+            runs.push_back({i, i + 1, files_writers[i]});
+        }
+    }
+    return runs;
+}
+
+int main(int argc, char *argv[]) {
+
+    try
+    {
+        int rank=0;
+        int nproc=1;
+
+        /* Initialize MPI */
+        initParallelContext(argc, argv, rank, nproc);
+
+        std::optional<ExtractOptions> options = parseExtractOptions(argc, argv);
+
+#ifdef DECRYPT_ALL
+        if(options && options->patterns.empty()){
+            options->patterns.push_back("*");
+        }
+#endif
+
+        if(!options || options->patterns.empty()){
+            if(rank==0){
+                std::cout << usage << std::endl;
+                printExtractUsage();
+            }
+            exit(1);
+        }
+
+        /* Initialize ADIOS2, with the engines of the config file if any */
+        adios2::ADIOS adios = createAdios(options->adios_config);
+
+        /* Configure the library that wrote the cipher-text */
+        IOBackendFactory io_factory;
+        std::unique_ptr<IOBackend> backend = io_factory.createBackend(options->io_backend, 
+                                                                adios, options->mpiio_hints,
+                                                                options->direct_io);
+
+        /* Configure cipher type and mode */
+
+        CipherType cipher_type {getCipherType(std::string_view{options->cipher_name}, rank)};
+
+        CipherFactory f;
+        std::unique_ptr<Cipher> cipher = f.createCipher(cipher_type);
+        FileDecryptor decryptor(*cipher);
+
+        /* Configure the codec that compressed the files, if any */
+        CodecFactory codec_factory;
+        std::unique_ptr<Codec> codec = codec_factory.createCodec(options->codec, 0);
+
+        /* Keys of the processes that wrote the cipher-text, and the
+        metadata of all files */
+
+        std::string passphrase;
+        if(!options->passphrase_file.empty()){
+            passphrase = loadPassphrase(options->passphrase_file);
+        }
+
+        std::vector<ProcessKey> keys = loadKeyFile(options->key_file, passphrase);
+        GlobalCTMeta metadata = backend->readGlobalMetadata(options->metadata_file);
+
+        size_t n_writers = metadata.local_counts.size();
+
+        if(keys.size() != n_writers){
+            throw std::runtime_error("The key file holds " + std::to_string(keys.size()) +
+                                    " keys, but the cipher-text was written by " +
+                                    std::to_string(n_writers) + " processes");
+        }
+
+        /* Files are stored in rank order, so the process that
+        encrypted a file follows from the number of files per process */
+        std::vector<size_t> files_writers;
+
+        for(size_t writer=0; writer<n_writers; writer++){
+            files_writers.insert(files_writers.end(), metadata.local_counts[writer], writer);
+        }
+
+        if(files_writers.size() != metadata.files_sizes.size()){
+            throw std::runtime_error("Number of files per process does not match the metadata");
+        }
+
+        /* Look up the requested files */
+
+        std::vector<size_t> matches;
+
+        for(size_t i=0; i<metadata.files_names.size(); i++){
+            for(const std::string &pattern : options->patterns){
+                if(fnmatch(pattern.c_str(), metadata.files_names[i].c_str(), 0) == 0){
+                    matches.push_back(i);
+                    break;
+                }
+            }
+        }
+
+        if(rank==0){
+            std::cout << matches.size() << " of " << metadata.files_names.size() <<
+                        " files match" << std::endl;
+            std::filesystem::create_directories(options->output_directory);
+        }
+        waitForProcesses();
+
+        /* Balance the matching files by bytes across the current processes */
+
+        std::vector<size_t> matches_sizes(matches.size());
+        for(size_t match=0; match<matches.size(); match++){
+            matches_sizes[match] = metadata.files_sizes[matches[match]];
+        }
+
+        std::vector<size_t> partition_counts;
+        std::vector<size_t> partition_displacements;
+        decomposeBySize(matches_sizes, partition_counts, partition_displacements, nproc);
+
+        std::vector<size_t> local_files(matches.begin() + partition_displacements[rank],
+                        matches.begin() + partition_displacements[rank] + partition_counts[rank]);
+        std::vector<FileRun> runs = groupRuns(local_files, files_writers);
+
+        /* Each run is read from its first file to the end of its last one */
+
+        std::vector<size_t> starts(runs.size());
+        std::vector<size_t> counts(runs.size());
+
+        for(size_t r=0; r<runs.size(); r++){
+
+            const FileRun &run = runs[r];
+            size_t run_offset = metadata.files_offsets[run.first];
+            size_t run_end = metadata.files_offsets[run.last - 1] + 
+                            metadata.files_sizes[run.last - 1];
+
+            starts[r] = metadata.global_offsets[run.writer] + run_offset;
+            counts[r] = run_end - run_offset;
+        }
+
+        double read_seconds, decryption_seconds, start_time;
+        waitForProcesses();
+        start_time = getTime();
+
+        std::vector<std::vector<uint8_t>> ciphertexts = backend->readDataRanges(
+                                                options->data_file, starts, counts);
+
+        waitForProcesses();
+        read_seconds = getTime() - start_time;
+        start_time = getTime();
+
+        ByteBuffer padded_plaintext;
+        ByteBuffer file_contents;
+
+        for(size_t r=0; r<runs.size(); r++){
+
+            const FileRun &run = runs[r];
+            size_t run_offset = metadata.files_offsets[run.first];
+
+            cipher->setKeyWithIV(keys[run.writer].key, keys[run.writer].iv);
+
+            for(size_t i=run.first; i<run.last; i++){
+
+                padded_plaintext.resize(metadata.files_sizes[i]);
+
+                /* Decryption of the file from its own IV */
+                decryptor.decrypt(padded_plaintext.data(),
+                                ciphertexts[r].data() + (metadata.files_offsets[i] - run_offset),
+                                metadata.files_sizes[i], i);
+
+                const unsigned char *file_plaintext = padded_plaintext.data();
+
+                /* Only the bytes encrypted are kept. The padding must agree 
+                with them, which catches e.g. a wrong key, and so must the tags */
+                size_t payload_size = metadata.files_compressed_sizes[i];
+                size_t plaintext_size = metadata.files_orig_sizes[i];
+                if((cipher->requiresPadding() && 
+                    unpaddedSize(file_plaintext, metadata.files_sizes[i]) != payload_size) ||
+                    (cipher->isAuthenticated() && 
+                    authenticatedPayloadSize(metadata.files_sizes[i]) != payload_size)){
+                    throw std::runtime_error("Decrypted size does not match the metadata of file: " +
+                                            metadata.files_names[i]);
+                }
+
+                /* Compressed files are restored before being written */
+                if(payload_size != plaintext_size){
+
+                    if(!codec){
+                        throw std::runtime_error("File was compressed, give its codec with "
+                                                "--compress: " + metadata.files_names[i]);
+                    }
+
+                    file_contents.resize(plaintext_size);
+                    codec->expand(file_contents.data(), plaintext_size, file_plaintext, payload_size);
+                    file_plaintext = file_contents.data();
+                }
+
+                saveFile(std::filesystem::path(options->output_directory) / metadata.files_names[i],
+                        file_plaintext, plaintext_size);
+            }
+
+            /* Release the cipher-text of the run once decrypted */
+            std::vector<uint8_t>().swap(ciphertexts[r]);
+        }
+
+        waitForProcesses();
+        decryption_seconds = getTime() - start_time;
+
+        if (rank==0){
+            std::cout<< "Parallel data reading time (s) = " << read_seconds << std::endl;
+            std::cout<< "Parallel decryption time (s) = " << decryption_seconds << std::endl;
+        }
+
+        endParallelContext();
+
+        return 0;
+    }
+
+    catch (std::exception  &e){
+
+        std::cout<< e.what() << std::endl;
+
+        exitParallelContext();
+
+        exit(1);
+    }
+
+}
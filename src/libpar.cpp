@@ -8,27 +8,54 @@
 
 #include "libpar.hpp"
 
+#include <iostream>
+
 /**
- * @brief Initializes MPI and create an ADIOS 2 parallel context. 
+ * @brief Initializes MPI. 
  *
  * This functions initializes MPI, sets the MPI rank, and the MPI world size.
- * It also creates and returns an ADIOS object initialized with  MPI_COMM_WORLD
+ * MPI_THREAD_FUNNELED is requested because worker threads may run alongside
+ * the main thread, which remains the only thread making MPI calls. The
+ * program is aborted if the MPI library does not provide that level, as
+ * the thread pools and writer threads would then be unsafe.
  *
  * @param argc  Refrence to command-line arguments' count  
  * @param argv  Reference to command-line arguments'vector  
  * @param rank  Reference to the rank of the calling process.
  * @param size  Reference to the MPI world size. 
- *
- * @return An ADIOS2 context initialized with MPI_COMM_WORLD.
  */
-adios2::ADIOS initParallelContext(int &argc, char ** &argv, int &rank, int &size) {
+void initParallelContext(int &argc, char ** &argv, int &rank, int &size) {
     
-    MPI_Init(&argc, &argv);
+    int thread_support;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_support);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-    adios2::ADIOS adios(MPI_COMM_WORLD);
-    return adios;
+    if (thread_support < MPI_THREAD_FUNNELED) {
+        if (rank == 0) {
+            std::cerr << "The MPI library does not support MPI_THREAD_FUNNELED, "
+                        "required by the worker threads" << std::endl;
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+/**
+ * @brief Creates an ADIOS 2 parallel context on MPI_COMM_WORLD. 
+ *
+ * The engine and its parameters can be set per IO at runtime through an 
+ * ADIOS 2 XML or YAML config file, recognised by its extension. IOs that 
+ * the file does not mention use the default BP engine.
+ *
+ * @param config_file  Path to the ADIOS 2 config file; empty for none.
+ * @return An ADIOS2 context initialized with MPI_COMM_WORLD.
+ */
+adios2::ADIOS createAdios(const std::string config_file) {
+
+    if (config_file.empty()) {
+        return adios2::ADIOS(MPI_COMM_WORLD);
+    }
+    return adios2::ADIOS(config_file, MPI_COMM_WORLD);
 }
 
 /**
@@ -70,6 +97,43 @@ void exclusive_scan(const void *send_buffer, void *recv_buffer, int count,
     MPI_Exscan(send_buffer, recv_buffer, count, datatype, operation, comm);
 }
 
+/**
+ * @brief Performs MPI_Bcast routine
+ *
+ * This function wraps the MPI_Bcast routine, sending the contents of a 
+ * buffer from the root rank to all other ranks.
+ *
+ * @param buffer      Pointer to the buffer to send (root) or receive into (others).
+ * @param count       Number of elements in the buffer.
+ * @param datatype    MPI_Datatype of elements.
+ * @param root        Rank of the process sending the buffer.
+ * @param comm        MPI communicator over which to perform the broadcast.
+ **/
+void broadcast(void *buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm) {
+    
+    MPI_Bcast(buffer, count, datatype, root, comm);
+}
+
+/**
+ * @brief Performs MPI_Gather routine
+ *
+ * This function wraps the MPI_Gather routine, collecting the same number
+ * of elements from every rank into a buffer of the root rank, in rank order.
+ *
+ * @param send_buffer Pointer to the elements sent by the calling process.
+ * @param recv_buffer Pointer to the buffer receiving count elements per rank 
+ *                    (significant at root only).
+ * @param count       Number of elements sent by each rank.
+ * @param datatype    MPI_Datatype of elements.
+ * @param root        Rank of the process receiving the elements.
+ * @param comm        MPI communicator over which to perform the gather.
+ **/
+void gather(const void *send_buffer, void *recv_buffer, int count, MPI_Datatype datatype,
+            int root, MPI_Comm comm) {
+    
+    MPI_Gather(send_buffer, count, datatype, recv_buffer, count, datatype, root, comm);
+}
+
 /**
  * @brief Performs MPI_Barrier routine
  *
@@ -142,4 +206,62 @@ void decompose1D(size_t global_size, size_t &offset, size_t &local_size, int npr
     } else {
         offset = rank * local_size + remainder;
     }
+}
+
+/**
+ * @brief 1D decomposition of a list of files across ranks, balanced by bytes.
+ *
+ * Splits a list of files into nproc contiguous ranges so that the total 
+ * number of bytes assigned to each process is as close as possible to the 
+ * global number of bytes divided by the number of processes. The ranges are
+ * built by greedy prefix splitting: the range of rank r ends at the file 
+ * boundary closest to the prefix sum (r+1) * total_bytes / nproc. A process 
+ * may be assigned no files when a single file is larger than its share.
+ *
+ * @param files_sizes    Size in bytes of each file, in dataset order.
+ * @param counts         Reference to the vector receiving the number of files
+ *                       assigned to each process (resized to nproc).
+ * @param displacements  Reference to the vector receiving the index of the 
+ *                       first file assigned to each process (resized to nproc).
+ * @param nproc          Total number of MPI processes.
+ */
+void decomposeBySize(const std::vector<size_t> &files_sizes, std::vector<size_t> &counts,
+                    std::vector<size_t> &displacements, int nproc) {
+    
+    counts.assign(nproc, 0);
+    displacements.assign(nproc, 0);
+
+    size_t total_bytes = 0;
+    for (size_t file_size : files_sizes) {
+        total_bytes += file_size;
+    }
+
+    size_t n_files = files_sizes.size();
+    size_t file = 0;
+    size_t prefix_bytes = 0;
+
+    for (int rank = 0; rank < nproc; rank++) {
+
+        displacements[rank] = file;
+
+        if (rank == nproc - 1) {
+            file = n_files;
+        } 
+        else {
+            size_t target_bytes = static_cast<size_t>(
+                static_cast<long double>(total_bytes) * (rank + 1) / nproc);
+
+            while (file < n_files && prefix_bytes + files_sizes[file] <= target_bytes) {
+                prefix_bytes += files_sizes[file++];
+            }
+
+            /* Take the file straddling the target if that ends the range closer to it */
+            if (file < n_files && 
+                prefix_bytes + files_sizes[file] - target_bytes < target_bytes - prefix_bytes) {
+                prefix_bytes += files_sizes[file++];
+            }
+        }
+
+        counts[rank] = file - displacements[rank];
+    }
 }
\ No newline at end of file
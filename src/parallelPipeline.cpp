@@ -6,9 +6,13 @@
  * 
  * This script executes a pipeline that encrypts a dataset in parallel 
  * using Crypto++ and through distributed memory parallelism, writes the corresponding 
- * cipher-text in parallel through ADIOS 2, reads in back in parallel 
- * through ADIOS 2, and decrypts it in parallel using Crypto++ and 
+ * cipher-text in parallel through ADIOS 2 or MPI-IO, reads in back in parallel 
+ * through the same library, and decrypts it in parallel using Crypto++ and 
  * through distributed memory parallelism. 
+ *
+ * Built with -DENCRYPT_ONLY (bin/encrypt), it stops once the cipher-text and
+ * metadata are written, and saves the keys with --key-file, so that they are
+ * read back and decrypted by a separate job (bin/decrypt).
  */
 
 #include <files.h>
@@ -19,6 +23,8 @@
 #include <string>
 #include <string_view>
 #include <cstdlib>
+#include <algorithm>
+#include <thread>
 
 #include "libpar.hpp"
 #include "adios.hpp"
@@ -27,6 +33,15 @@
 #include "cryptography.hpp"
 #include "CipherFactory.hpp"
 #include "Cipher.hpp"
+#include "ThreadPool.hpp"
+#include "CryptoStage.hpp"
+#include "AsyncFileWriter.hpp"
+#include "BatchedReader.hpp"
+#include "keyFile.hpp"
+#include "NodeAggregator.hpp"
+#include "IOBackendFactory.hpp"
+#include "CodecFactory.hpp"
+#include "gzip.hpp"
 
 using namespace CryptoPP;
 
@@ -36,6 +51,98 @@ const double min_runtime_seconds = 3.0;
 /* CPU frequency */
 const double cpu_frequency = 2.1 * 1000 * 1000 * 1000; 
 
+#ifdef ENCRYPT_ONLY
+static const bool encrypt_only = true;
+static const char *usage = "Usage : mpirun -n <number> ./bin/encrypt <dataset directory> "
+                        "<ALGORITHM_MODE> --key-file=<path> [options]";
+#else
+static const bool encrypt_only = false;
+static const char *usage = "Usage : mpirun -n <number> ./bin/parallel <dataset directory> "
+                        "<ALGORITHM_MODE> [options]";
+#endif
+
+/* Timings of a repeated I/O operation */
+struct IOTimes {
+    double open_seconds = 0;
+    double steady_seconds = 0;
+    double close_seconds = 0;
+    int iterations = 0;
+};
+
+/**
+ * @brief Times an I/O operation, repeated until it has run for at least
+ * min_runtime_seconds.
+ *
+ * Opening, the repeated iterations, and closing are timed separately, 
+ * each between barriers.
+ *
+ * @param open       Function run once before the iterations.
+ * @param iteration  Function run for each iteration, given its index.
+ * @param close      Function run once after the iterations.
+ * @return The timings of the three phases and the number of iterations.
+ */
+template <typename Open, typename Iteration, typename Close>
+static IOTimes timeIterations(Open open, Iteration iteration, Close close){
+
+    IOTimes times;
+
+    waitForProcesses();
+    double start = getTime();
+
+    open();
+    waitForProcesses();
+    double opened = getTime();
+    times.open_seconds = opened - start;
+
+    do{
+        iteration(times.iterations);
+        waitForProcesses();
+
+        times.iterations++;
+        times.steady_seconds = getTime() - opened;
+    }
+    while (times.steady_seconds < min_runtime_seconds);
+
+    double closing = getTime();
+    close();
+    waitForProcesses();
+    times.close_seconds = getTime() - closing;
+
+    return times;
+}
+
+/**
+ * @brief Prints the timings of a repeated I/O operation.
+ *
+ * @param label       Description of the operation.
+ * @param times       Timings of the operation.
+ * @param persistent  Whether the file was kept open, in which case the 
+ *                    open and close times are printed as well.
+ * @param n_bytes     Bytes moved per iteration across all processes, to 
+ *                    print the steady-state bandwidth of a persistent 
+ *                    engine; 0 to omit it.
+ */
+static void printTimes(const std::string &label, const IOTimes &times, bool persistent,
+                    size_t n_bytes){
+
+    if(!persistent){
+        std::cout<< label << " time (s) = " << times.steady_seconds << 
+                    " for " << times.iterations << " iterations"<< std::endl;
+        return;
+    }
+
+    std::cout<< label << " open time (s) = " << times.open_seconds << std::endl;
+    std::cout<< label << " steady-state time (s) = " << times.steady_seconds << 
+                " for " << times.iterations << " steps"<< std::endl;
+    std::cout<< label << " close time (s) = " << times.close_seconds << std::endl;
+
+    if(n_bytes > 0){
+        std::cout<< label << " steady-state bandwidth (GB/s) = " << 
+                    n_bytes * static_cast<double>(times.iterations) / 
+                    times.steady_seconds / 1e9 << std::endl;
+    }
+}
+
 int main(int argc, char *argv[]) {
  
     try
@@ -43,8 +150,22 @@ int main(int argc, char *argv[]) {
         int rank=0;
         int nproc=1;
 
-        /* Initialize MPI and ADIOS2 */
-        adios2::ADIOS adios = initParallelContext(argc, argv, rank, nproc);
+        /* Initialize MPI */
+        initParallelContext(argc, argv, rank, nproc);
+
+        std::optional<PipelineOptions> options = parseOptions(argc, argv);
+
+        /* Without the keys, the cipher-text of bin/encrypt could not be decrypted */
+        if(!options || (encrypt_only && options->key_file.empty())){
+            if(rank==0){
+                std::cout << usage << std::endl;
+                printOptionsUsage();
+            }
+            exit(1);
+        }
+
+        /* Initialize ADIOS2, with the engines of the config file if any */
+        adios2::ADIOS adios = createAdios(options->adios_config);
 
         if (!adios) {
             std::runtime_error("Failed to initialize ADIOS\n");
@@ -52,18 +173,19 @@ int main(int argc, char *argv[]) {
             exit(1);
         }
 
+        /* Configure the library writing and reading the cipher-text */
+        IOBackendFactory io_factory;
+        std::unique_ptr<IOBackend> backend = io_factory.createBackend(options->io_backend, 
+                                                                adios, options->mpiio_hints,
+                                                                options->direct_io);
 
-        if(argc != 3){
-            if(rank==0){
-                std::cout << "Usage : mpirun -n <number> ./bin/parallel <dataset directory> "
-                        "<ALGORITHM_MODE>" << std::endl;
-            }
-            exit(1);
+        if(rank==0){
+            std::cout << "Parallel I/O through " << backend->name() << std::endl;
         }
 
         /* Configure input and output directories */
 
-        std::string dataset_directory = argv[1]; 
+        std::string dataset_directory = options->dataset_directory; 
         const std::filesystem::path data_path{dataset_directory};
         const std::filesystem::path output_path{"output"};
         
@@ -78,22 +200,82 @@ int main(int argc, char *argv[]) {
 
         /* Configure cipher type and mode */
 
-        std::string cipher_name = argv[2]; 
-        CipherType cipher_type {getEnumFromString(std::string_view{cipher_name}, rank)};
+        std::string cipher_name = options->cipher_name; 
+        CipherType cipher_type {getCipherType(std::string_view{cipher_name}, rank)};
         
         CipherFactory f;
         std::unique_ptr<Cipher> cipher = f.createCipher(cipher_type);  
-        auto encryptor = cipher->createEncryptor();
+
+        /* Configure threads for the chunked encryption of large files, 
+        or for the encryption of several files at once */
+
+        ThreadPool pool(options->n_threads);
+        CryptoStage crypto(*cipher, pool, options->chunk_bytes, options->threading);
 
         if(rank==0){
-            std::visit([&](auto &pointer){          
+            std::cout << crypto.algorithmName() << " Encryption Benchmark" << std::endl;
+        }
+
+        if(rank==0 && crypto.isChunked()){
+            std::cout << "Chunked encryption with " << pool.size() << " threads per process, "
+                        << options->chunk_bytes << " bytes per chunk" << std::endl;
+        }
+
+        if(rank==0 && crypto.isFileParallel()){
+            std::cout << "File-parallel encryption with " << pool.size() << 
+                        " threads per process" << std::endl;
+        }
+
+        /* Authenticated modes encrypt whole files, not the pieces of io_uring 
+        reads or of the streaming buffers */
+        if(crypto.isAuthenticated() && 
+            (options->input == INPUT_URING || options->stream_bytes > 0)){
+            throw std::runtime_error("Authenticated ciphers cannot be combined with "
+                                    "--input=uring or --stream-buffer");
+        }
+
+        /* Configure the compression of each file before its encryption */
+
+        CodecFactory codec_factory;
+        std::unique_ptr<Codec> codec = codec_factory.createCodec(options->codec, 
+                                                            options->compression_level);
 
-                /* deference pointer to get Crypto++ encryption object */
-                auto &encryption_object = *pointer;         
+        if(rank==0 && codec){
+            std::cout << "Compression with " << codec->name() << ", " << pool.size() << 
+                        " threads per process" << std::endl;
+        }
+
+        if(rank==0 && options->gunzip){
+            std::cout << "Gzip decompression of the input with " << pool.size() << 
+                        " threads per process" << std::endl;
+        }
+
+        /* Files are held in memory between decompression or compression and encryption */
+        bool staged = codec || options->gunzip;
+
+        /* Rank 0 saves the key and IV of every process, so that files can 
+        later be decrypted by bin/decrypt or one at a time by bin/extract */
+        if(!options->key_file.empty()){
+
+            const SecByteBlock &key = cipher->getKey();
+            const SecByteBlock &iv = cipher->getIV();
+
+            SecByteBlock record(key.size() + iv.size());
+            std::copy(key.begin(), key.end(), record.begin());
+            std::copy(iv.begin(), iv.end(), record.begin() + key.size());
+
+            SecByteBlock records(rank==0 ? record.size() * nproc : 0);
+            gather(record.data(), records.data(), record.size(), MPI_UNSIGNED_CHAR, 0, 
+                    MPI_COMM_WORLD);
 
-                std::cout << encryption_object.AlgorithmName() << 
-                            " Encryption Benchmark" << std::endl;
-            }, encryptor);
+            if(rank==0){
+                std::string passphrase;
+                if(!options->passphrase_file.empty()){
+                    passphrase = loadPassphrase(options->passphrase_file);
+                }
+                saveKeyFile(options->key_file, records, nproc, key.size(), iv.size(), 
+                            passphrase);
+            }
         }
 
         /* Dataset Partitioning */
@@ -110,8 +292,25 @@ int main(int argc, char *argv[]) {
         /* Calculation of how many dataset files each process encrypts 
         and starting from which offset in the data directory */
 
-        for(int i=0; i<nproc; i++){
-            decompose1D(files_list.size(), displacements[i], counts[i], nproc, i);
+        if(options->partition == PARTITION_BYTES){
+
+            /* Rank 0 collects the size of each file and shares it with 
+            all processes, which then balance the bytes per process */
+            std::vector<size_t> input_sizes(files_list.size());
+
+            if(rank==0){
+                for(size_t i=0; i<files_list.size(); i++){
+                    input_sizes[i] = std::filesystem::file_size(files_list[i]);
+                }
+            }
+            broadcast(input_sizes.data(), input_sizes.size(), MPI_UINT64_T, 0, MPI_COMM_WORLD);
+
+            decomposeBySize(input_sizes, counts, displacements, nproc);
+        }
+        else{
+            for(int i=0; i<nproc; i++){
+                decompose1D(files_list.size(), displacements[i], counts[i], nproc, i);
+            }
         }
 
         size_t local_start_idx= displacements[rank];
@@ -119,83 +318,114 @@ int main(int argc, char *argv[]) {
 
         /* Parallel Encryption */
 
-        std::vector<unsigned char> ciphertext;
+        ByteBuffer ciphertext;
+        std::vector<size_t> plaintexts_sizes;
         std::vector<size_t> files_sizes;
         std::vector<size_t> files_offsets;
+        std::vector<size_t> files_compressed_sizes;
+        std::vector<ByteBuffer> payload_files;
+        std::string files_names;
         size_t file_offset=0;
+
+        size_t CT_local_size=0;
+        size_t CT_global_size;
+        size_t CT_global_offset;
+
+        /* In streaming mode encryption and data writing overlap */
+        bool streaming = options->stream_bytes > 0;
+
         
         if (rank==0){
-            std::cout<< "Encrypting... " << std::endl;
+            if(streaming){
+                std::cout<< "Encrypting and writing with " << options->stream_bytes << 
+                            " bytes buffers... " << std::endl;
+            }
+            else{
+                std::cout<< "Encrypting... " << std::endl;
+            }
         }
         
         double encryption_seconds, start_encryption_time, end_encryption_time; 
+        double compression_seconds = 0;
+        double gunzip_seconds = 0;
+        size_t gzip_bytes = 0;
         waitForProcesses();
         start_encryption_time = getTime();
-            
+
         for (size_t i=local_start_idx; i<local_end_idx; i++){
+            plaintexts_sizes.push_back(std::filesystem::file_size(files_list[i]));
+        }
 
-            std::vector<unsigned char> plaintext = loadFile(files_list[i]);
-            std::vector<unsigned char> padded_plaintext(plaintext);
-    
-            /* Add padding */
-            if(cipher->requiresPadding()){
-                addPadding(padded_plaintext, N_BLOCK_BYTES);
+        /* Gzip files are decompressed whole, by all threads whatever the threading 
+        of the encryption, so that their raw contents are encrypted */
+        if(options->gunzip){
+            double start_gunzip_time = getTime();
+            payload_files.resize(counts[rank]);
+
+            pool.parallelFor(counts[rank], [&](size_t local_index, unsigned int){
+                payload_files[local_index] = gunzipFile(files_list[local_start_idx + local_index], 
+                                                    plaintexts_sizes[local_index], 
+                                                    options->input == INPUT_MMAP);
+            });
+
+            for(size_t local_index=0; local_index<plaintexts_sizes.size(); local_index++){
+                gzip_bytes += plaintexts_sizes[local_index];
+                plaintexts_sizes[local_index] = payload_files[local_index].size();
             }
 
-            size_t input_size = padded_plaintext.size();
-            std::vector<unsigned char> file_ciphertext(input_size); 
-
-            std::visit([&](auto &pointer){
-                
-                /* Deference pointer to access Crypto++ encryption object */
-                auto &encryption_object = *pointer;           
+            gunzip_seconds = getTime() - start_gunzip_time;
+        }
 
-                /* Encryption */
-                encryption_object.ProcessData(file_ciphertext.data(), 
-                                            padded_plaintext.data(), 
-                                            input_size);
+        /* Files are compressed whole, by all threads whatever the threading 
+        of the encryption, and then encrypted from memory */
+        if(codec){
+            double start_compression_time = getTime();
+            payload_files.resize(counts[rank]);
+
+            pool.parallelFor(counts[rank], [&](size_t local_index, unsigned int){
+                if(options->gunzip){
+                    payload_files[local_index] = codec->compressBuffer(
+                                                std::move(payload_files[local_index]));
+                }
+                else{
+                    payload_files[local_index] = codec->compressFile(
+                                                files_list[local_start_idx + local_index], 
+                                                plaintexts_sizes[local_index], 
+                                                options->input == INPUT_MMAP);
+                }
+            });
+
+            compression_seconds = getTime() - start_compression_time;
+        }
 
-            }, encryptor);
+        /* The layout of the local cipher-text is computed from the file sizes, 
+        so that each file is encrypted directly into its final position */
+        for (size_t i=local_start_idx; i<local_end_idx; i++){
 
-            ciphertext.insert(ciphertext.end(), file_ciphertext.begin(), 
-                                file_ciphertext.end());
+            size_t local_index = i - local_start_idx;
+            size_t payload_size = staged ? payload_files[local_index].size() : 
+                                        plaintexts_sizes[local_index];
+            size_t input_size = crypto.encryptedSize(payload_size);
 
             /* Save metadata of file being encrypted in vectors */
+            files_compressed_sizes.push_back(payload_size);
             files_sizes.push_back(input_size);
             files_offsets.push_back(file_offset);
+
+            /* Names are stored NUL-terminated in a single table. Decompressed 
+            gzip files are named without their extension */
+            files_names.append(options->gunzip ? gunzippedName(files_list[i]).string() : 
+                                                files_list[i].filename().string());
+            files_names.push_back('\0');
             
             file_offset += input_size; 
         }
+        CT_local_size = file_offset;
 
-        waitForProcesses();
-        end_encryption_time = getTime();
-        encryption_seconds = end_encryption_time - start_encryption_time;   
-        
-        if (rank==0){
-            std::cout << " Parallel encryption time (s) = " << 
-                        encryption_seconds <<std::endl;
-        }
- 
-        /* Parallel Write of metadata */
-        size_t CT_local_size=ciphertext.size();
-        size_t CT_global_size;
-        size_t CT_global_offset;
-
-        int write_data_iterations=0;
-        int write_metadata_iterations=0;
-        double write_data_seconds, start_write_data, end_write_data; 
-        double write_metadata_seconds, start_write_metadata, end_write_metadata; 
-        
-        waitForProcesses();  
-        start_write_metadata = getTime();
+        if(streaming){
 
-        do{
-            /* Calculate size of global cipher-text */
             reduce_and_broadcast(&CT_local_size, &CT_global_size, 1, MPI_UINT64_T, MPI_SUM, 
                                 MPI_COMM_WORLD);
-
-            /*Calculate global offset of local cipher-texts 
-            within the global cipher-text. */
             exclusive_scan(&CT_local_size, &CT_global_offset, 1, MPI_UINT64_T, MPI_SUM, 
                     MPI_COMM_WORLD);
 
@@ -203,136 +433,568 @@ int main(int argc, char *argv[]) {
                 CT_global_offset=0;
             };
 
-            parallelWriteMetadata(adios, nproc, rank, 1, CT_local_size, CT_global_offset, 
-                                    files_list.size(), counts[rank], displacements[rank], 
-                                    files_sizes, files_offsets, metadata_output_path,
-                                    std::to_string(write_metadata_iterations));
+            /* All processes take part in as many write rounds as the 
+            process with the most buffers */
+            size_t local_rounds = (CT_local_size + options->stream_bytes - 1) / 
+                                  options->stream_bytes;
+            size_t n_rounds;
+            reduce_and_broadcast(&local_rounds, &n_rounds, 1, MPI_UINT64_T, MPI_MAX, 
+                                MPI_COMM_WORLD);
 
-            waitForProcesses();
-            end_write_metadata = getTime();
+            /* Double buffering: one buffer is encrypted while the other is written */
+            BoundedQueue<std::vector<uint8_t>> full_buffers(2);
+            BoundedQueue<std::vector<uint8_t>> free_buffers(2);
+            free_buffers.push(std::vector<uint8_t>(options->stream_bytes));
+            free_buffers.push(std::vector<uint8_t>(options->stream_bytes));
+
+            std::exception_ptr encryption_error;
+
+            /* The encryption thread fills the buffers, while the main 
+            thread keeps issuing the ADIOS 2 and MPI calls */
+            std::thread encryption_thread([&](){
+
+                try{
+                    std::optional<std::vector<uint8_t>> buffer = free_buffers.pop();
+                    size_t filled = 0;
+
+                    /* Reused across files when reading into memory */
+                    ByteBuffer padded_plaintext;
+
+                    /* Encrypts bytes into the buffers, handing each buffer to the 
+                    writer once full. Pieces of a file always start and end at block 
+                    boundaries, since both the buffer size and the padded file sizes 
+                    are multiples of the block size */
+                    auto streamBytes = [&](const unsigned char *input, size_t length, 
+                                        size_t file_index, size_t file_offset){
+
+                        size_t position = 0;
+
+                        while(buffer && position < length){
+
+                            size_t piece = std::min(length - position, buffer->size() - filled);
+
+                            crypto.encrypt(buffer->data() + filled, input + position, piece,
+                                        file_index, file_offset + position);
+
+                            filled += piece;
+                            position += piece;
+
+                            if(filled == buffer->size()){
+                                full_buffers.push(std::move(*buffer));
+                                buffer = free_buffers.pop();
+                                filled = 0;
+                            }
+                        }
+                    };
+
+                    /* Streams a whole plain-text, or its last piece, with the padded 
+                    last block built in a small tail buffer */
+                    auto streamPadded = [&](const unsigned char *input, size_t length, 
+                                        size_t file_index, size_t file_offset){
+
+                        if(cipher->requiresPadding()){
+                            unsigned char tail[N_BLOCK_BYTES];
+                            size_t body_size = copyPaddedTail(tail, input, length, N_BLOCK_BYTES);
+                            streamBytes(input, body_size, file_index, file_offset);
+                            streamBytes(tail, N_BLOCK_BYTES, file_index, file_offset + body_size);
+                        }
+                        else{
+                            streamBytes(input, length, file_index, file_offset);
+                        }
+                    };
+
+                    if(options->input == INPUT_URING){
+
+                        /* Buffers are filled in file order, so pieces are handed 
+                        over in that order whatever order their reads complete in */
+                        std::vector<std::filesystem::path> local_files(
+                                    files_list.begin() + local_start_idx, 
+                                    files_list.begin() + local_end_idx);
+                        BatchedReader reader(options->read_depth, true);
+
+                        reader.readFiles(local_files, plaintexts_sizes, 
+                                        [&](size_t local_index, size_t file_offset, 
+                                            const unsigned char *data, size_t length){
+
+                            size_t i = local_start_idx + local_index;
+
+                            if(file_offset + length == plaintexts_sizes[local_index]){
+                                streamPadded(data, length, i, file_offset);
+                            }
+                            else{
+                                streamBytes(data, length, i, file_offset);
+                            }
+                        });
+                    }
+                    else{
+                        for (size_t i=local_start_idx; buffer && i<local_end_idx; i++){
+
+                            size_t local_index = i - local_start_idx;
+
+                            if(staged){
+
+                                /* Stream the file held in memory, then release it */
+                                streamPadded(payload_files[local_index].data(), 
+                                            payload_files[local_index].size(), i, 0);
+                                ByteBuffer().swap(payload_files[local_index]);
+                            }
+                            else if(options->input == INPUT_MMAP){
+
+                                MappedFile plaintext(files_list[i]);
+
+                                if(plaintext.size() != plaintexts_sizes[local_index]){
+                                    throw std::runtime_error("File changed size during encryption: " + 
+                                                            files_list[i].string());
+                                }
+
+                                /* Stream the mapped pages directly */
+                                streamPadded(plaintext.data(), plaintext.size(), i, 0);
+                            }
+                            else{
+                                padded_plaintext.resize(files_sizes[local_index]);
+                                loadFileInto(files_list[i], padded_plaintext.data(), 
+                                            plaintexts_sizes[local_index]);
+
+                                /* Add padding */
+                                if(cipher->requiresPadding()){
+                                    addPaddingInPlace(padded_plaintext.data(), 
+                                                    plaintexts_sizes[local_index], N_BLOCK_BYTES);
+                                }
+
+                                streamBytes(padded_plaintext.data(), padded_plaintext.size(), 
+                                            i, 0);
+                            }
+                        }
+                    }
+
+                    if(buffer && filled > 0){
+                        buffer->resize(filled);
+                        full_buffers.push(std::move(*buffer));
+                    }
+                }
+                catch(...){
+                    encryption_error = std::current_exception();
+                }
+
+                full_buffers.close();
+            });
+
+            try{
+                backend->streamWriteData(full_buffers, free_buffers, encryption_output_path, 
+                                    CT_global_size, CT_local_size, CT_global_offset, 
+                                    n_rounds);
+            }
+            catch(...){
+                /* Release the encryption thread before leaving */
+                free_buffers.close();
+                full_buffers.close();
+                encryption_thread.join();
+
+                /* A failed encryption closes the stream early, so its error 
+                is the cause of the backend's */
+                if(encryption_error){
+                    std::rethrow_exception(encryption_error);
+                }
+                throw;
+            }
 
-            write_metadata_iterations++;
+            encryption_thread.join();
 
-            write_metadata_seconds = end_write_metadata - start_write_metadata;
+            if(encryption_error){
+                std::rethrow_exception(encryption_error);
+            }
+        }
+        else if(options->input == INPUT_URING){
+            ciphertext.resize(CT_local_size);
+
+            /* Pieces of the files are encrypted as soon as their reads complete, 
+            into their final position. Chained modes need them in file order */
+            std::vector<std::filesystem::path> local_files(files_list.begin() + local_start_idx, 
+                                                        files_list.begin() + local_end_idx);
+            BatchedReader reader(options->read_depth, !crypto.isOrderIndependent());
+
+            reader.readFiles(local_files, plaintexts_sizes, 
+                            [&](size_t local_index, size_t file_offset, 
+                                const unsigned char *data, size_t length){
+
+                size_t i = local_start_idx + local_index;
+                size_t stream_offset = files_offsets[local_index] + file_offset;
+
+                /* The last piece of a file receives the padding */
+                if(file_offset + length == plaintexts_sizes[local_index]){
+                    crypto.encryptPadded(ciphertext.data() + stream_offset, data, length, 
+                                        i, file_offset);
+                }
+                else{
+                    crypto.encrypt(ciphertext.data() + stream_offset, data, length, 
+                                i, file_offset);
+                }
+            });
+        }
+        else{
+            ciphertext.resize(CT_local_size);
+
+            /* Each file is encrypted into its own region of the cipher-text, 
+            so files can be encrypted by different threads */
+            crypto.forEachFile(counts[rank], [&](size_t local_index, unsigned int worker_id){
+
+                size_t i = local_start_idx + local_index;
+                unsigned char *file_ciphertext = ciphertext.data() + files_offsets[local_index];
+
+                if(staged){
+
+                    /* Encrypt the file held in memory, then release it */
+                    crypto.encryptPadded(file_ciphertext, payload_files[local_index].data(),
+                                        payload_files[local_index].size(), i, 0, worker_id);
+                    ByteBuffer().swap(payload_files[local_index]);
+                }
+                else if(options->input == INPUT_MMAP){
+
+                    /* Encrypt directly from the mapped pages */
+                    MappedFile plaintext(files_list[i]);
+
+                    if(plaintext.size() != plaintexts_sizes[local_index]){
+                        throw std::runtime_error("File changed size during encryption: " + 
+                                                files_list[i].string());
+                    }
+
+                    crypto.encryptPadded(file_ciphertext, plaintext.data(),
+                                        plaintext.size(), i, 0, worker_id);
+                }
+                else{
+                    /* Read the plain-text into its final position and pad it there */
+                    loadFileInto(files_list[i], file_ciphertext, plaintexts_sizes[local_index]);
+
+                    /* Authenticated modes write the tags after the file */
+                    if(crypto.isAuthenticated()){
+                        crypto.encryptPadded(file_ciphertext, file_ciphertext, 
+                                            plaintexts_sizes[local_index], i, 0, worker_id);
+                        return;
+                    }
+            
+                    /* Add padding */
+                    if(cipher->requiresPadding()){
+                        addPaddingInPlace(file_ciphertext, plaintexts_sizes[local_index], 
+                                        N_BLOCK_BYTES);
+                    }
+
+                    /* Encrypt in place */
+                    crypto.encrypt(file_ciphertext, file_ciphertext,
+                                files_sizes[local_index], i, 0, worker_id);
+                }
+            });
         }
-        while (write_metadata_seconds < min_runtime_seconds);
-
 
-        /* Parallel write of cipher-text */
         waitForProcesses();
-        start_write_data = getTime();
-
-        do{
-            parallelWriteData(adios, ciphertext, encryption_output_path, CT_global_size , 
-                    CT_local_size, CT_global_offset, std::to_string(write_data_iterations));
-            
-            waitForProcesses();
-            end_write_data = getTime();
+        end_encryption_time = getTime();
+        encryption_seconds = end_encryption_time - start_encryption_time;   
 
-            write_data_iterations++;
+        /* The gzip decompression is reported across all processes: the slowest 
+        process, and the bytes of all files before and after decompression */
+        if(options->gunzip){
+            double max_gunzip_seconds;
+            reduce_and_broadcast(&gunzip_seconds, &max_gunzip_seconds, 1, MPI_DOUBLE, 
+                                MPI_MAX, MPI_COMM_WORLD);
 
-            write_data_seconds = end_write_data - start_write_data;
-        }
-        while(write_data_seconds < min_runtime_seconds);
+            size_t local_bytes[2] = {gzip_bytes, 0};
+            size_t global_bytes[2];
 
-        if (rank==0){
-            std::cout<< "Parallel data writing time (s) = " << write_data_seconds << 
-                         " for " << write_data_iterations << " iterations"<< std::endl;
+            for(size_t plaintext_size : plaintexts_sizes){
+                local_bytes[1] += plaintext_size;
+            }
+            reduce_and_broadcast(local_bytes, global_bytes, 2, MPI_UINT64_T, MPI_SUM, 
+                                MPI_COMM_WORLD);
 
-            std::cout<< "Parallel metadata writing time (s) = " << write_metadata_seconds << 
-                        " for " << write_metadata_iterations << " iterations"<< std::endl;
+            if(rank==0){
+                std::cout << " Parallel gzip decompression time (s) = " << max_gunzip_seconds << 
+                            std::endl;
+                std::cout << " Parallel gzip decompression bandwidth (GB/s) = " << 
+                            global_bytes[1] / std::max(max_gunzip_seconds, 1e-9) / 1e9 <<
+                            " (" << global_bytes[0] << " to " << global_bytes[1] << " bytes)" << 
+                            std::endl;
+            }
         }
 
-        /* Parallel read of metadata */
-        std::vector<unsigned char> ciphertext_read(CT_local_size);
-        ParallelCTMeta metadata_read;
-        int read_data_iterations=0;
-        int read_metadata_iterations=0;
-        double read_data_seconds, start_read_data, end_read_data; 
-        double read_metadata_seconds, start_read_metadata, end_read_metadata; 
-        
-        waitForProcesses();  
-        start_read_metadata = getTime();
+        /* The compression is reported across all processes: the slowest 
+        process, and the bytes of all files before and after compression */
+        if(codec){
+            double max_compression_seconds;
+            reduce_and_broadcast(&compression_seconds, &max_compression_seconds, 1, MPI_DOUBLE, 
+                                MPI_MAX, MPI_COMM_WORLD);
 
-        do{
-            metadata_read = parallelReadMetadata(adios, metadata_output_path, nproc, rank, 1,
-                                             displacements[rank], counts[rank],
-                                             std::to_string(read_metadata_iterations));
-            waitForProcesses();
-            end_read_metadata = getTime();
+            size_t local_bytes[2] = {0, 0};
+            size_t global_bytes[2];
 
-            read_metadata_iterations++;
+            for(size_t local_index=0; local_index<plaintexts_sizes.size(); local_index++){
+                local_bytes[0] += plaintexts_sizes[local_index];
+                local_bytes[1] += files_compressed_sizes[local_index];
+            }
+            reduce_and_broadcast(local_bytes, global_bytes, 2, MPI_UINT64_T, MPI_SUM, 
+                                MPI_COMM_WORLD);
 
-            read_metadata_seconds = end_read_metadata - start_read_metadata;
+            if(rank==0){
+                std::cout << " Parallel compression time (s) = " << max_compression_seconds << 
+                            std::endl;
+                std::cout << " Compression ratio = " << 
+                            static_cast<double>(global_bytes[0]) / std::max<size_t>(global_bytes[1], 1) <<
+                            " (" << global_bytes[0] << " to " << global_bytes[1] << " bytes)" << 
+                            std::endl;
+            }
         }
-        while (read_metadata_seconds < min_runtime_seconds);
         
-        /* Parallel read of cipher-text */
-        waitForProcesses();
-        start_read_data = getTime();
+        if (rank==0){
+            if(streaming){
+                std::cout << " Parallel streaming encryption and data writing time (s) = " << 
+                            encryption_seconds <<std::endl;
+            }
+            else{
+                std::cout << " Parallel encryption time (s) = " << 
+                            encryption_seconds <<std::endl;
+            }
+        }
+ 
+        /* Parallel Write of metadata. In persistent mode, the file is opened 
+        once and each iteration writes a step */
+        bool persistent = options->io_mode == IO_PERSISTENT;
+        size_t names_local_size = files_names.size();
+        size_t names_global_size;
+        size_t names_global_offset;
+
+        IOTimes write_metadata_times = timeIterations(
+            [&](){
+                if(persistent){
+                    backend->openMetadata(metadata_output_path, true);
+                }
+            },
+            [&](int){
+                /* Calculate size of global cipher-text */
+                reduce_and_broadcast(&CT_local_size, &CT_global_size, 1, MPI_UINT64_T, MPI_SUM, 
+                                    MPI_COMM_WORLD);
+
+                /*Calculate global offset of local cipher-texts 
+                within the global cipher-text. */
+                exclusive_scan(&CT_local_size, &CT_global_offset, 1, MPI_UINT64_T, MPI_SUM, 
+                        MPI_COMM_WORLD);
+
+                /* Calculate size and offsets of the table of file names */
+                reduce_and_broadcast(&names_local_size, &names_global_size, 1, MPI_UINT64_T, 
+                                    MPI_SUM, MPI_COMM_WORLD);
+                exclusive_scan(&names_local_size, &names_global_offset, 1, MPI_UINT64_T, MPI_SUM, 
+                        MPI_COMM_WORLD);
+
+                if(rank==0){
+                    CT_global_offset=0;
+                    names_global_offset=0;
+                };
+
+                if(!persistent){
+                    backend->openMetadata(metadata_output_path, true);
+                }
+
+                backend->writeMetadata(nproc, rank, CT_local_size, CT_global_offset, 
+                                    files_list.size(), counts[rank], displacements[rank], 
+                                    files_sizes, files_offsets, plaintexts_sizes, 
+                                    files_compressed_sizes, files_names, names_global_size, 
+                                    names_global_offset);
+
+                if(!persistent){
+                    backend->closeMetadata();
+                }
+            },
+            [&](){
+                if(persistent){
+                    backend->closeMetadata();
+                }
+            });
+
+
+        /* Parallel write of cipher-text, unless it was 
+        already written while encrypting */
+        if(!streaming){
+
+            /* With aggregation, each iteration stages the cipher-texts of a group 
+            in shared memory, then only the aggregator of the group puts them */
+            std::optional<NodeAggregator> aggregator;
+            std::vector<DataBlock> data_blocks{{ciphertext.data(), CT_global_offset, 
+                                                CT_local_size}};
+
+            if(options->ranks_per_aggregator > 0){
+                aggregator.emplace(options->ranks_per_aggregator, CT_local_size, 
+                                CT_global_offset);
+                data_blocks = aggregator->blocks();
+
+                if(rank==0){
+                    std::cout << "Node aggregation with " << aggregator->nAggregators() << 
+                                " aggregators" << std::endl;
+                }
+            }
 
-        do{
-            ciphertext_read = parallelReadData(adios, encryption_output_path, 
-                                            metadata_read.local_size, 
-                                            metadata_read.global_offset,
-                                            std::to_string(read_data_iterations));
-            waitForProcesses();
-            end_read_data = getTime();
+            IOTimes write_data_times = timeIterations(
+                [&](){
+                    if(persistent){
+                        backend->openData(encryption_output_path, true);
+                    }
+                },
+                [&](int){
+                    if(aggregator){
+                        aggregator->aggregate(ciphertext.data());
+                    }
+
+                    if(!persistent){
+                        backend->openData(encryption_output_path, true);
+                    }
+
+                    backend->writeData(data_blocks, CT_global_size);
+
+                    if(!persistent){
+                        backend->closeData();
+                    }
+                },
+                [&](){
+                    if(persistent){
+                        backend->closeData();
+                    }
+                });
+
+            if (rank==0){
+                printTimes("Parallel data writing", write_data_times, persistent, CT_global_size);
+            }
+        }
 
-            read_data_iterations++;
+        if (rank==0){
+            printTimes("Parallel metadata writing", write_metadata_times, persistent, 0);
+        }
 
-            read_data_seconds = end_read_data - start_read_data;
+        /* bin/encrypt leaves the read and decryption to bin/decrypt */
+        if(encrypt_only){
+            endParallelContext();
+            return 0;
         }
-        while (read_data_seconds < min_runtime_seconds);
+
+        /* Parallel read of metadata. In persistent mode, iterations 
+        read the steps of the file in turn */
+        std::vector<unsigned char> ciphertext_read(CT_local_size);
+        ParallelCTMeta metadata_read;
+        size_t n_steps = 1;
+        
+        IOTimes read_metadata_times = timeIterations(
+            [&](){
+                if(persistent){
+                    backend->openMetadata(metadata_output_path, false);
+                    n_steps = backend->metadataSteps();
+                }
+            },
+            [&](int iteration){
+                if(!persistent){
+                    backend->openMetadata(metadata_output_path, false);
+                }
+
+                metadata_read = backend->readMetadata(iteration % n_steps, nproc, rank, 
+                                                    displacements[rank], counts[rank]);
+
+                if(!persistent){
+                    backend->closeMetadata();
+                }
+            },
+            [&](){
+                if(persistent){
+                    backend->closeMetadata();
+                }
+            });
         
+        /* Parallel read of cipher-text */
+        IOTimes read_data_times = timeIterations(
+            [&](){
+                if(persistent){
+                    backend->openData(encryption_output_path, false);
+                    n_steps = backend->dataSteps();
+                }
+            },
+            [&](int iteration){
+                if(!persistent){
+                    backend->openData(encryption_output_path, false);
+                }
+
+                ciphertext_read = backend->readData(iteration % n_steps, 
+                                                metadata_read.local_size, 
+                                                metadata_read.global_offset);
+
+                if(!persistent){
+                    backend->closeData();
+                }
+            },
+            [&](){
+                if(persistent){
+                    backend->closeData();
+                }
+            });
 
         if (rank==0){
-            std::cout<< "Parallel data reading time (s) = " << read_data_seconds << 
-                         " for " << read_data_iterations << " iterations"<< std::endl;
-
-            std::cout<< "Parallel metadata reading time (s) = " << read_metadata_seconds << 
-                        " for " << read_metadata_iterations << " iterations"<< std::endl;
+            printTimes("Parallel data reading", read_data_times, persistent, CT_global_size);
+            printTimes("Parallel metadata reading", read_metadata_times, persistent, 0);
         }
 
         /* Parallel Decryption */
 
-        auto decryptor = cipher->createDecryptor();
-        
         if (rank==0){
             std::cout<< "Decrypting... " << std::endl;
         }
 
-        for (size_t i=local_start_idx; i<local_end_idx; i++){
+        /* Decrypted files are written in the background, in buffers that are 
+        reused once written so memory does not grow with the number of files */
+        AsyncFileWriter writer(options->n_writers, options->queue_depth);
 
-            size_t local_index= i-local_start_idx;
+        crypto.forEachFile(counts[rank], [&](size_t local_index, unsigned int worker_id){
+
+            size_t input_size = metadata_read.files_sizes[local_index];
+            ByteBuffer padded_plaintext = writer.takeBuffer();
         
-            std::vector<unsigned char> padded_plaintext(metadata_read.files_sizes[local_index]);
+            padded_plaintext.resize(input_size);
             
-            std::visit([&](auto &pointer) {
+            /* Decryption */
+            crypto.decrypt(padded_plaintext.data(),
+                        ciphertext_read.data() + metadata_read.files_offsets[local_index],
+                        input_size, local_start_idx + local_index, worker_id);
+
+            /* Only the bytes encrypted are kept. The padding must agree 
+            with them, which catches e.g. a wrong key, and so must the tags */
+            size_t payload_size = metadata_read.files_compressed_sizes[local_index];
+            size_t plaintext_size = metadata_read.files_orig_sizes[local_index];
+            if((cipher->requiresPadding() && 
+                unpaddedSize(padded_plaintext.data(), input_size) != payload_size) ||
+                (crypto.isAuthenticated() && authenticatedPayloadSize(input_size) != payload_size)){
+                throw std::runtime_error("Decrypted size does not match the metadata of file: " +
+                                        metadata_read.files_names[local_index]);
+            }
 
-                /* Deference pointer to access Crypto++ encryption object */
-                auto &decryption_object = *pointer;
+            /* Names come from the metadata, not from the dataset directory */
+            const std::string decrypted_file_name = decryption_output_path.string() + 
+                                                    metadata_read.files_names[local_index];
+
+            /* Compressed files are restored before being written */
+            if(payload_size != plaintext_size){
 
-                /* Decryption */
-                decryption_object.ProcessData(
-                padded_plaintext.data(),
-                ciphertext_read.data() + metadata_read.files_offsets[local_index],
-                metadata_read.files_sizes[local_index]);
+                if(!codec){
+                    throw std::runtime_error("Cannot restore compressed file: " + 
+                                            metadata_read.files_names[local_index]);
+                }
 
-            }, decryptor);
+                ByteBuffer file_contents = writer.takeBuffer();
+                file_contents.resize(plaintext_size);
+                codec->expand(file_contents.data(), plaintext_size, padded_plaintext.data(), 
+                            payload_size);
 
-            std::vector<unsigned char> plaintext(padded_plaintext);
+                /* The decrypted buffer goes back to the pool once expanded */
+                writer.recycleBuffer(std::move(padded_plaintext));
 
-            /* Remove padding */
-            if(cipher->requiresPadding()){
-                removePadding(plaintext);
+                writer.write(decrypted_file_name, std::move(file_contents), plaintext_size);
+                return;
             }
 
-            const std::string decrypted_file_name = decryption_output_path.string() + 
-                                                    files_list[i].filename().string();
+            writer.write(decrypted_file_name, std::move(padded_plaintext), plaintext_size);
+        });
 
-            saveFile(decrypted_file_name, plaintext); 
-        }
+        writer.finish();
 
         if (rank==0){
             std::cout << "The program finished decryption" <<std::endl;
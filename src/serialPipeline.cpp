@@ -16,6 +16,7 @@
 #include <hrtimer.h>
 #include <string>
 #include <string_view>
+#include <algorithm>
 
 #include "fileIO.hpp"
 #include "parsing.hpp"
@@ -23,6 +24,13 @@
 #include "cryptography.hpp"
 #include "CipherFactory.hpp"
 #include "Cipher.hpp"
+#include "ThreadPool.hpp"
+#include "CryptoStage.hpp"
+#include "AsyncFileWriter.hpp"
+#include "BatchedReader.hpp"
+#include "AlignedFile.hpp"
+#include "CodecFactory.hpp"
+#include "gzip.hpp"
 
 using namespace CryptoPP;
 
@@ -39,18 +47,21 @@ int main(int argc, char *argv[]) {
         int rank=0;    
         int nproc=1;  
         
-        if(argc != 3){
+        std::optional<PipelineOptions> options = parseOptions(argc, argv);
+
+        if(!options){
             std::cout << "Usage : ./bin/serial <dataset directory> "
-                        "<ALGORITHM_MODE>" << std::endl;
+                        "<ALGORITHM_MODE> [options]" << std::endl;
+            printOptionsUsage();
             exit(1);
         }
 
         /* Initialize MPI so to use the MPI timer */ 
-        adios2::ADIOS adios = initParallelContext(argc, argv, rank, nproc);
+        initParallelContext(argc, argv, rank, nproc);
 
         /* Configure input and output directories */
 
-        std::string dataset_directory = argv[1]; 
+        std::string dataset_directory = options->dataset_directory; 
         const std::filesystem::path output_path{"output"};
         setDirectory(output_path);
         const std::filesystem::path data_path{dataset_directory};
@@ -60,72 +71,249 @@ int main(int argc, char *argv[]) {
 
         /* Configure cipher type and mode */
 
-        std::string cipher_name = argv[2]; 
-        CipherType cipher_type {getEnumFromString(std::string_view{cipher_name}, 0)};
+        std::string cipher_name = options->cipher_name; 
+        CipherType cipher_type {getCipherType(std::string_view{cipher_name}, 0)};
         
         CipherFactory f;
         std::unique_ptr<Cipher> cipher = f.createCipher(cipher_type);  
-        auto encryptor = cipher->createEncryptor();
 
-        std::visit([&](auto &pointer){     
+        /* Configure threads for the chunked encryption of large files, 
+        or for the encryption of several files at once */
+
+        ThreadPool pool(options->n_threads);
+        CryptoStage crypto(*cipher, pool, options->chunk_bytes, options->threading);
+
+        std::cout << crypto.algorithmName() << " Encryption Benchmark" << std::endl;
+
+        if(crypto.isChunked()){
+            std::cout << "Chunked encryption with " << pool.size() << " threads, "
+                        << options->chunk_bytes << " bytes per chunk" << std::endl;
+        }
+
+        if(crypto.isFileParallel()){
+            std::cout << "File-parallel encryption with " << pool.size() << " threads" << std::endl;
+        }
+
+        /* Authenticated modes encrypt whole files, not the pieces of io_uring reads */
+        if(crypto.isAuthenticated() && options->input == INPUT_URING){
+            throw std::runtime_error("Authenticated ciphers require --input=read or --input=mmap");
+        }
+
+        /* Configure the compression of each file before its encryption */
+
+        CodecFactory codec_factory;
+        std::unique_ptr<Codec> codec = codec_factory.createCodec(options->codec, 
+                                                            options->compression_level);
+
+        if(codec){
+            std::cout << "Compression with " << codec->name() << ", " << pool.size() << 
+                        " threads" << std::endl;
+        }
 
-            /* Deference pointer to get CryptoPP encryption object */
-            auto &encryption_object = *pointer;      
+        if(options->gunzip){
+            std::cout << "Gzip decompression of the input with " << pool.size() << 
+                        " threads" << std::endl;
+        }
 
-            std::cout << encryption_object.AlgorithmName() << 
-                        " Encryption Benchmark" << std::endl;
-        }, encryptor);
+        /* Files are held in memory between decompression or compression and encryption */
+        bool staged = codec || options->gunzip;
 
         /* Serial Encryption */
 
-        std::vector<unsigned char> ciphertext;
+        ByteBuffer ciphertext;
         std::vector <CTMeta> ciphertexts_info; 
+        std::vector <std::filesystem::path> files_list;
+        std::vector<size_t> plaintexts_sizes;
+        std::vector<ByteBuffer> payload_files;
         size_t file_offset=0;
         std::cout<< "Encrypting... " << std::endl;
 
         double encryption_start, encryption_end, encryption_seconds;
+        double compression_start, compression_seconds = 0;
+        double gunzip_start, gunzip_seconds = 0;
+        size_t gzip_bytes = 0;
 
         encryption_start = getTime();
-        
+
         for (auto const &file_directory: 
             std::filesystem::directory_iterator{data_path}){
+            files_list.push_back(file_directory.path());
+            plaintexts_sizes.push_back(std::filesystem::file_size(file_directory.path()));
+        }
 
-            std::vector<unsigned char> plaintext = loadFile(file_directory.path());
-            std::vector<unsigned char> padded_plaintext(plaintext);
-    
-            /* Add padding */
-            if(cipher->requiresPadding()){
-                addPadding(padded_plaintext, N_BLOCK_BYTES);
+        /* Gzip files are decompressed whole, by all threads whatever the threading 
+        of the encryption, so that their raw contents are encrypted */
+        if(options->gunzip){
+            gunzip_start = getTime();
+            payload_files.resize(files_list.size());
+
+            pool.parallelFor(files_list.size(), [&](size_t i, unsigned int){
+                payload_files[i] = gunzipFile(files_list[i], plaintexts_sizes[i],
+                                            options->input == INPUT_MMAP);
+            });
+
+            for (size_t i=0; i<files_list.size(); i++){
+                gzip_bytes += plaintexts_sizes[i];
+                plaintexts_sizes[i] = payload_files[i].size();
             }
 
-            size_t input_size = padded_plaintext.size();
-            std::vector<unsigned char> file_ciphertext(input_size);
-            
-            std::visit([&](auto &pointer){
+            gunzip_seconds = getTime() - gunzip_start;
+        }
 
-                /* Deference pointer to get Crypto++ encryption object */
-                auto &encryption_object = *pointer;           
+        /* Files are compressed whole, by all threads whatever the threading 
+        of the encryption, and then encrypted from memory */
+        if(codec){
+            compression_start = getTime();
+            payload_files.resize(files_list.size());
+
+            pool.parallelFor(files_list.size(), [&](size_t i, unsigned int){
+                if(options->gunzip){
+                    payload_files[i] = codec->compressBuffer(std::move(payload_files[i]));
+                }
+                else{
+                    payload_files[i] = codec->compressFile(files_list[i], plaintexts_sizes[i],
+                                                        options->input == INPUT_MMAP);
+                }
+            });
+
+            compression_seconds = getTime() - compression_start;
+        }
 
-                /* Encrypt */
-                encryption_object.ProcessData(file_ciphertext.data(),
-                                            padded_plaintext.data(),
-                                            input_size);
-            }, encryptor);
+        /* The cipher-text of each file is placed at its final offset, computed 
+        from the file sizes, so the cipher-text buffer is allocated only once */
+        for (size_t i=0; i<files_list.size(); i++){
 
-            ciphertext.insert(ciphertext.end(), file_ciphertext.begin(), 
-                            file_ciphertext.end()); 
+            size_t payload_size = staged ? payload_files[i].size() : plaintexts_sizes[i];
+            size_t input_size = crypto.encryptedSize(payload_size);
 
-            /* Save metadata of file being encrypted in vectors */
-            ciphertexts_info.push_back({file_directory.path().filename(), 
-                                        input_size, file_offset}); 
+            /* Save metadata of file being encrypted in vectors. Decompressed 
+            gzip files are named without their extension */
+            std::filesystem::path file_name = options->gunzip ? gunzippedName(files_list[i]) : 
+                                                            files_list[i].filename();
+            ciphertexts_info.push_back({file_name, input_size, file_offset, 
+                                        plaintexts_sizes[i], payload_size}); 
             file_offset += input_size ; 
         }
 
+        ciphertext.resize(file_offset);
+        
+        if(options->input == INPUT_URING){
+
+            /* Pieces of the files are encrypted as soon as their reads complete, 
+            into their final position. Chained modes need them in file order */
+            BatchedReader reader(options->read_depth, !crypto.isOrderIndependent());
+
+            reader.readFiles(files_list, plaintexts_sizes, 
+                            [&](size_t i, size_t file_offset, 
+                                const unsigned char *data, size_t length){
+
+                size_t stream_offset = ciphertexts_info[i].offset + file_offset;
+
+                /* The last piece of a file receives the padding */
+                if(file_offset + length == plaintexts_sizes[i]){
+                    crypto.encryptPadded(ciphertext.data() + stream_offset, data, length, 
+                                        i, file_offset);
+                }
+                else{
+                    crypto.encrypt(ciphertext.data() + stream_offset, data, length, 
+                                i, file_offset);
+                }
+            });
+        }
+        else{
+            /* Each file is encrypted into its own region of the cipher-text, 
+            so files can be encrypted by different threads */
+            crypto.forEachFile(files_list.size(), [&](size_t i, unsigned int worker_id){
+
+                unsigned char *file_ciphertext = ciphertext.data() + ciphertexts_info[i].offset;
+
+                if(staged){
+
+                    /* Encrypt the file held in memory, then release it */
+                    crypto.encryptPadded(file_ciphertext, payload_files[i].data(),
+                                        payload_files[i].size(), i, 0, worker_id);
+                    ByteBuffer().swap(payload_files[i]);
+                }
+                else if(options->input == INPUT_MMAP){
+
+                    /* Encrypt directly from the mapped pages */
+                    MappedFile plaintext(files_list[i]);
+
+                    if(plaintext.size() != plaintexts_sizes[i]){
+                        throw std::runtime_error("File changed size during encryption: " + 
+                                                files_list[i].string());
+                    }
+
+                    crypto.encryptPadded(file_ciphertext, plaintext.data(),
+                                        plaintext.size(), i, 0, worker_id);
+                }
+                else{
+                    /* Read the plain-text into its final position and pad it there */
+                    loadFileInto(files_list[i], file_ciphertext, plaintexts_sizes[i]);
+        
+                    /* Authenticated modes write the tags after the file */
+                    if(crypto.isAuthenticated()){
+                        crypto.encryptPadded(file_ciphertext, file_ciphertext, plaintexts_sizes[i],
+                                            i, 0, worker_id);
+                        return;
+                    }
+
+                    /* Add padding */
+                    if(cipher->requiresPadding()){
+                        addPaddingInPlace(file_ciphertext, plaintexts_sizes[i], N_BLOCK_BYTES);
+                    }
+                
+                    /* Encrypt in place */
+                    crypto.encrypt(file_ciphertext, file_ciphertext,
+                                ciphertexts_info[i].size, i, 0, worker_id);
+                }
+            });
+        }
+
         encryption_end = getTime();
-        encryption_seconds = encryption_end - encryption_start;
+        encryption_seconds = encryption_end - encryption_start - compression_seconds - 
+                            gunzip_seconds;
+
+        if(options->gunzip){
+            size_t gunzipped_bytes = 0;
+
+            for(size_t plaintext_size : plaintexts_sizes){
+                gunzipped_bytes += plaintext_size;
+            }
+
+            std::cout << "Gzip decompression time (s) = " << gunzip_seconds << std::endl;
+            std::cout << "Gzip decompression bandwidth (GB/s) = " << 
+                        gunzipped_bytes / std::max(gunzip_seconds, 1e-9) / 1e9 <<
+                        " (" << gzip_bytes << " to " << gunzipped_bytes << " bytes)" << std::endl;
+        }
+
+        if(codec){
+            size_t original_bytes = 0;
+            size_t compressed_bytes = 0;
+
+            for(const CTMeta &meta : ciphertexts_info){
+                original_bytes += meta.orig_size;
+                compressed_bytes += meta.compressed_size;
+            }
+
+            std::cout << "Compression time (s) = " << compression_seconds << std::endl;
+            std::cout << "Compression ratio = " << 
+                        static_cast<double>(original_bytes) / std::max<size_t>(compressed_bytes, 1) <<
+                        " (" << original_bytes << " to " << compressed_bytes << " bytes)" << std::endl;
+        }
         
         std::cout << "Encryption time (s) = " << encryption_seconds <<std::endl;
 
+        if(codec){
+            std::cout << "Compression and encryption time (s) = " << 
+                        encryption_seconds + compression_seconds << std::endl;
+        }
+
+        if(options->gunzip){
+            std::cout << "Gzip decompression, compression and encryption time (s) = " << 
+                        encryption_seconds + compression_seconds + gunzip_seconds << std::endl;
+        }
+
         /* Serial write of data */
 
         int write_data_iterations=0;
@@ -133,10 +321,20 @@ int main(int argc, char *argv[]) {
         double write_data_start, write_data_end, write_data_seconds;
         double write_metadata_start, write_metadata_end, write_metadata_seconds ;
 
+        /* With O_DIRECT, the cipher-text is written through aligned buffers
+        reused across iterations */
+        AlignedBufferPool buffer_pool;
+
         write_data_start = getTime();
         
         do{
-            saveFile(encryption_output_path, ciphertext); 
+            if(options->direct_io){
+                AlignedFile(encryption_output_path, true, true, buffer_pool)
+                    .writeContents(ciphertext.data(), ciphertext.size());
+            }
+            else{
+                saveFile(encryption_output_path, ciphertext.data(), ciphertext.size()); 
+            }
             write_data_end = getTime();
             write_data_iterations++;
             write_data_seconds = write_data_end - write_data_start;
@@ -146,7 +344,12 @@ int main(int argc, char *argv[]) {
         /* Serial write of metadata */
         write_metadata_start = getTime();
         do{
-            saveMetadataFile(metadata_output_path, ciphertexts_info);
+            if(options->metadata_format == METADATA_TEXT){
+                saveMetadataFile(metadata_output_path, ciphertexts_info);
+            }
+            else{
+                saveBinaryMetadataFile(metadata_output_path, ciphertexts_info);
+            }
             write_metadata_end=getTime();
             write_metadata_iterations++;
             write_metadata_seconds = write_metadata_end - write_metadata_start;
@@ -165,6 +368,7 @@ int main(int argc, char *argv[]) {
         int read_metadata_iterations=0;
         std::vector<unsigned char> ciphertext_read;
         std::vector<CTMeta> metadata_read;
+        std::optional<MetadataTable> metadata_table;
 
         double read_data_start,read_data_end, read_data_seconds;
         double read_metadata_start, read_metadata_end, read_metadata_seconds;
@@ -183,7 +387,13 @@ int main(int argc, char *argv[]) {
         read_metadata_start=getTime();
 
         do{
-            metadata_read = loadMetadataFile(metadata_output_path); 
+            /* The binary metadata is mapped and its records accessed in place */
+            if(options->metadata_format == METADATA_TEXT){
+                metadata_read = loadMetadataFile(metadata_output_path); 
+            }
+            else{
+                metadata_table.emplace(metadata_output_path);
+            }
             read_metadata_end=getTime();
             read_metadata_iterations++;
             read_metadata_seconds = read_metadata_end - read_metadata_start; 
@@ -198,37 +408,69 @@ int main(int argc, char *argv[]) {
                 
         /* Serial Decryption */
 
-        auto decryptor = cipher->createDecryptor();
         std::cout<< "Decrypting..."<< std::endl;
 
-        for (const auto &CT_meta_data : metadata_read) {
-        
-            std::vector<unsigned char> padded_plaintext(CT_meta_data.size);
+        /* Decrypted files are written in the background, in buffers that are 
+        reused once written so memory does not grow with the number of files */
+        AsyncFileWriter writer(options->n_writers, options->queue_depth);
 
-            std::visit([&](auto &pointer) {
+        size_t n_files = metadata_table ? metadata_table->size() : metadata_read.size();
 
-                /* Deference pointer to access Crypto++ encryption object */
-                auto &decryption_object = *pointer;
+        crypto.forEachFile(n_files, [&](size_t i, unsigned int worker_id){
 
-                /* Decryption */
-                decryption_object.ProcessData(
-                    padded_plaintext.data(),
-                    ciphertext_read.data() + CT_meta_data.offset,
-                    CT_meta_data.size);
-            }, decryptor);
+            CTMeta CT_meta_data = metadata_table ? (*metadata_table)[i] : metadata_read[i];
+            ByteBuffer padded_plaintext = writer.takeBuffer();
+        
+            padded_plaintext.resize(CT_meta_data.size);
 
-            std::vector<unsigned char> plaintext(padded_plaintext);
+            /* Decryption */
+            crypto.decrypt(padded_plaintext.data(),
+                        ciphertext_read.data() + CT_meta_data.offset,
+                        CT_meta_data.size, i, worker_id);
 
-            /* Remove padding */
+            /* Only the bytes before the padding or the tags are written. The 
+            padding must agree with the metadata, which catches e.g. a wrong key */
+            size_t plaintext_size = CT_meta_data.size;
             if(cipher->requiresPadding()){
-                removePadding(plaintext);
+                plaintext_size = unpaddedSize(padded_plaintext.data(), CT_meta_data.size);
+            }
+            else if(crypto.isAuthenticated()){
+                plaintext_size = authenticatedPayloadSize(CT_meta_data.size);
+            }
+
+            if(plaintext_size != CT_meta_data.compressed_size){
+                throw std::runtime_error("Decrypted size does not match the metadata of file: " +
+                                        CT_meta_data.file_name);
             }
 
             const std::string decrypted_file_name = decryption_output_path.string() + 
                                                     CT_meta_data.file_name;
 
-            saveFile(decrypted_file_name, plaintext);  
-        }
+            /* Compressed files are restored before being written */
+            if(CT_meta_data.compressed_size != CT_meta_data.orig_size){
+
+                if(!codec){
+                    throw std::runtime_error("Cannot restore compressed file: " + 
+                                            CT_meta_data.file_name);
+                }
+
+                ByteBuffer file_contents = writer.takeBuffer();
+                file_contents.resize(CT_meta_data.orig_size);
+                codec->expand(file_contents.data(), CT_meta_data.orig_size, 
+                            padded_plaintext.data(), CT_meta_data.compressed_size);
+
+                /* The decrypted buffer goes back to the pool once expanded */
+                writer.recycleBuffer(std::move(padded_plaintext));
+
+                writer.write(decrypted_file_name, std::move(file_contents), 
+                            CT_meta_data.orig_size);
+                return;
+            }
+
+            writer.write(decrypted_file_name, std::move(padded_plaintext), plaintext_size);
+        });
+
+        writer.finish();
 
         std::cout << "The program finished decryption" <<std::endl;
         
@@ -10,6 +10,10 @@
 
 #include "cryptography.hpp"
 
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
  /**
  * @brief Applies PKCS#7 padding to a vector of bytes.
  *
@@ -29,6 +33,76 @@ void addPadding(std::vector<unsigned char> &input, int block_size){
 }
 
 
+/**
+ * @brief Computes the size of an input once PKCS#7 padding is applied.
+ *
+ * PKCS#7 always adds between 1 and block_size bytes, so the result is the 
+ * next multiple of the block size strictly greater than the input size.
+ *
+ * @param input_size  Size in bytes of the unpadded input.
+ * @param block_size  Block size in bytes.
+ * @return The size in bytes of the padded input.
+ */
+size_t paddedSize(size_t input_size, int block_size){
+    
+    return input_size + (block_size - (input_size % block_size));
+}
+
+
+/**
+ * @brief Applies PKCS#7 padding in place, after the input within its buffer.
+ *
+ * This function writes the PKCS#7 padding bytes directly after the input,
+ * in a buffer that was sized for the padded input, avoiding the copy made 
+ * when padding a vector.
+ *
+ * @param buffer      Pointer to a buffer of paddedSize(input_size, block_size) 
+ *                    bytes whose first input_size bytes hold the input.
+ * @param input_size  Size in bytes of the unpadded input.
+ * @param block_size  Block size in bytes.
+ * @return The size in bytes of the padded input.
+ */
+size_t addPaddingInPlace(unsigned char *buffer, size_t input_size, int block_size){
+    
+    int padding_size = block_size - (input_size % block_size);
+
+    std::memset(buffer + input_size, padding_size, padding_size);
+
+    return input_size + padding_size;
+}
+
+
+/**
+ * @brief Builds the last block of a PKCS#7-padded input without copying the input.
+ *
+ * This function copies the trailing partial block of the input to a separate
+ * block-sized tail buffer and fills the rest of it with PKCS#7 padding bytes. 
+ * The padded input is then the concatenation of the first returned bytes of 
+ * the input and the tail, so that the bulk of the input can be encrypted in 
+ * place (e.g. from a memory-mapped file).
+ *
+ * @param tail        Pointer to a buffer of block_size bytes receiving the last block.
+ * @param input       Pointer to the unpadded input.
+ * @param input_size  Size in bytes of the unpadded input.
+ * @param block_size  Block size in bytes.
+ * @return The number of input bytes preceding the tail, a multiple of block_size.
+ */
+size_t copyPaddedTail(unsigned char *tail, const unsigned char *input, 
+                    size_t input_size, int block_size){
+    
+    size_t tail_size = input_size % block_size;
+    size_t body_size = input_size - tail_size;
+    int padding_size = block_size - tail_size;
+
+    if (tail_size > 0) {
+        std::memcpy(tail, input + body_size, tail_size);
+    }
+    std::memset(tail + tail_size, padding_size, padding_size);
+
+    return body_size;
+}
+
+
 /**
  * @brief Removes PKCS#7 padding from a vector of bytes.
  *
@@ -42,4 +116,32 @@ void removePadding(std::vector<unsigned char> &input) {
     unsigned char padding_value = input.back(); 
 
     input.resize(input.size() - padding_value);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Computes the size of a PKCS#7-padded input once padding is removed.
+ *
+ * This function reads the padding value from the last byte of the input 
+ * without resizing or copying it, so that only the unpadded bytes of a 
+ * buffer can be used, e.g. written to a file.
+ *
+ * @param input       Pointer to the padded input.
+ * @param input_size  Size in bytes of the padded input.
+ * @return The size in bytes of the unpadded input.
+ *
+ * @throws std::runtime_error if the padding value exceeds the input size.
+ */
+size_t unpaddedSize(const unsigned char *input, size_t input_size){
+
+    if (input_size == 0) {
+        return 0;
+    }
+
+    unsigned char padding_value = input[input_size - 1];
+
+    if (padding_value > input_size) {
+        throw std::runtime_error("Invalid padding of " + std::to_string(padding_value) + 
+                                " bytes in a " + std::to_string(input_size) + " bytes input");
+    }
+    return input_size - padding_value;
+}
@@ -6,17 +6,26 @@
 * 
 * This module provides utility functions for reading and writing a
 * binary file serially through buffered I/O operations as well as 
-* functions to read and write a file containing CTMeta objects.
+* functions to read and write a file containing CTMeta objects, either 
+* as text or in a binary format. It also provides the MappedFile class to 
+* read a file through mmap, and the MetadataTable class built on it.
 */
 
 #include "fileIO.hpp"
 
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 
 /**
  * @brief Stream extraction operator for CTMeta objects.
  *
- * Reads the file name, size, and offset values from a given input stream
- * and assigns them to the corresponding members of a CTMeta object.
+ * Reads the file name, size, offset, original size and compressed size values 
+ * from a given input stream and assigns them to the corresponding members of a CTMeta object.
  *
  * @param input      Reference to the stream to read from.
  * @param metadata   Reference to a CTMeta object to be configured.
@@ -26,6 +35,8 @@ std::istream& operator>>(std::istream& input, CTMeta& metadata){
     input >> metadata.file_name;
     input >> metadata.size;
     input >> metadata.offset;
+    input >> metadata.orig_size;
+    input >> metadata.compressed_size;
     return input;
 }
 
@@ -69,12 +80,129 @@ std::vector<unsigned char> loadFile(const std::filesystem::path file_name){
     return buffer;
 }
 
+/**
+ * @brief Reads the contents of a binary file into an existing buffer.
+ *
+ * This function reads exactly length bytes from the start of a given file
+ * into memory provided by the caller, e.g. the final position of the file
+ * within a larger pre-allocated buffer, so that no intermediate buffer is
+ * allocated.
+ *
+ * @param file_name  Path to the file to load.
+ * @param buffer     Pointer to a buffer of at least length bytes.
+ * @param length     Number of bytes to read, normally the file size.
+ *
+ * @throws std::runtime_error if the file cannot be opened or holds fewer 
+ *         than length bytes.
+ */
+void loadFileInto(const std::filesystem::path file_name, unsigned char *buffer, size_t length){
+
+    std::ifstream file_stream(file_name, std::ios_base::binary);
+
+    if (!file_stream) {
+        throw std::runtime_error("Failed to open file for reading: " + file_name.string());
+    }
+
+    file_stream.read(reinterpret_cast<char*>(buffer), length);
+
+    if (static_cast<size_t>(file_stream.gcount()) != length) {
+        throw std::runtime_error("Failed to read " + std::to_string(length) + 
+                                " bytes from file: " + file_name.string());
+    }
+    file_stream.close();
+}
+
+/**
+ * @brief Maps the contents of a file into memory, read-only.
+ *
+ * This function maps a given file with mmap and advises the kernel that it
+ * will be read sequentially (MADV_SEQUENTIAL), so that pages are read ahead 
+ * aggressively and released early. The contents are accessed directly from 
+ * the page cache, without the copy into a heap buffer made by loadFile. 
+ * An empty file is represented by a null pointer and a size of 0.
+ *
+ * @param file_name  Path to the file to map.
+ *
+ * @throws std::runtime_error if the file cannot be opened or mapped.
+ */
+MappedFile::MappedFile(const std::filesystem::path file_name){
+
+    int file_descriptor = open(file_name.c_str(), O_RDONLY);
+
+    if (file_descriptor < 0) {
+        throw std::runtime_error("Failed to open file for reading: " + file_name.string());
+    }
+
+    struct stat file_status;
+    if (fstat(file_descriptor, &file_status) != 0) {
+        close(file_descriptor);
+        throw std::runtime_error("Failed to read the size of file: " + file_name.string());
+    }
+
+    length = file_status.st_size;
+
+    if (length > 0) {
+        void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+
+        if (mapping == MAP_FAILED) {
+            close(file_descriptor);
+            throw std::runtime_error("Failed to map file: " + file_name.string() + 
+                                    " (" + std::strerror(errno) + ")");
+        }
+
+        madvise(mapping, length, MADV_SEQUENTIAL);
+        address = static_cast<const unsigned char*>(mapping);
+    }
+
+    /* The mapping stays valid once the descriptor is closed */
+    close(file_descriptor);
+}
+
+/**
+ * @brief Unmaps the file.
+ */
+MappedFile::~MappedFile(){
+    if (address != nullptr) {
+        munmap(const_cast<unsigned char*>(address), length);
+    }
+}
+
+/**
+ * @brief Moves a mapping, leaving the source empty.
+ *
+ * @param other  Mapping to move from.
+ */
+MappedFile::MappedFile(MappedFile &&other) noexcept 
+    : address(other.address), length(other.length){
+    other.address = nullptr;
+    other.length = 0;
+}
+
+/**
+ * @brief Moves a mapping, unmapping the current one and leaving the source empty.
+ *
+ * @param other  Mapping to move from.
+ * @return Reference to this mapping.
+ */
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        if (address != nullptr) {
+            munmap(const_cast<unsigned char*>(address), length);
+        }
+        address = other.address;
+        length = other.length;
+        other.address = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
 /**
  * @brief Loads the contents of a file into a vector of CTMeta objects.
  *
  * This function opens a given file and reads all bytes into a 
  * vector of CTMeta objects. It assumes the file read uses the format: 
- *       <file_name> <size> <offset>
+ *       <file_name> <size> <offset> <orig_size> <compressed_size>
  *
  * @param file_name  Path to the metadata file.
  * @return A vector of CTMeta objects loaded from the file.
@@ -121,13 +249,30 @@ std::vector<CTMeta> loadMetadataFile(const std::filesystem::path file_name){
  * @throws std::runtime_error If the file cannot be opened for writing.
  */
 void saveFile(const std::filesystem::path file_name, const std::vector<unsigned char> &data) {
+    
+    saveFile(file_name, data.data(), data.size());
+}
+
+/**
+ * @brief Writes a buffer of bytes to a file.
+ *
+ * This function writes length bytes starting at a given pointer to a file,
+ * in binary mode. It allows writing part of a larger buffer without copying it.
+ *
+ * @param file_name  Path to the file to write.
+ * @param data       Pointer to the data to write.
+ * @param length     Number of bytes to write.
+ *
+ * @throws std::runtime_error If the file cannot be opened for writing.
+ */
+void saveFile(const std::filesystem::path file_name, const unsigned char *data, size_t length) {
     std::ofstream file(file_name, std::ios::binary);
 
     if (!file) {
         throw std::runtime_error("Failed to open file for writing: " + file_name.string());
     }
 
-    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    file.write(reinterpret_cast<const char*>(data), length);
     file.close();
 }
 
@@ -135,7 +280,9 @@ void saveFile(const std::filesystem::path file_name, const std::vector<unsigned
  * @brief Writes a vector of CTMeta objects to a file.
  *
  * This function writes a given vector of CTMeta objects 
- * in the format: <file_name> <size> <offset>.
+ * in the format: <file_name> <size> <offset> <orig_size> <compressed_size>. 
+ * File names containing whitespace cannot be read back: 
+ * the binary format should be used for those.
  *
  * @param file_name  Path to the file to write.
  * @param data       Vector containing the data to write.
@@ -149,7 +296,8 @@ void saveMetadataFile(const std::filesystem::path file_name, const std::vector<C
     if (!file) throw std::runtime_error("Failed to open file for writing: " + file_name.string());
 
     for (const auto& meta : metadata) {
-        file << meta.file_name << " " << meta.size << " " << meta.offset << "\n";
+        file << meta.file_name << " " << meta.size << " " << meta.offset << " " 
+             << meta.orig_size << " " << meta.compressed_size << "\n";
     }
     file.close();
 }
@@ -180,4 +328,130 @@ void setDirectory(const std::filesystem::path directory_name){
     std::filesystem::create_directories(directory_name / "decryptedData");
     std::filesystem::create_directories(directory_name / "metadata");
 
-}
\ No newline at end of file
+}
+
+
+/* Identifies binary metadata files, and their version */
+static const char metadata_magic[8] = {'C', 'T', 'M', 'E', 'T', 'A', '\0', '\0'};
+static const uint32_t metadata_version = 2;
+
+/**
+ * @brief Writes a vector of CTMeta objects to a file in binary format.
+ *
+ * The file holds a MetadataHeader, one fixed-width MetadataRecord per 
+ * object, and a table of the NUL-terminated file names referenced by the
+ * records. Integers are stored in the byte order of the writing machine.
+ *
+ * @param file_name  Path to the file to write.
+ * @param metadata   Vector containing the metadata to write.
+ *
+ * @throws std::runtime_error If the file cannot be opened for writing.
+ */
+void saveBinaryMetadataFile(const std::filesystem::path file_name, 
+                            const std::vector<CTMeta> &metadata) {
+
+    std::vector<MetadataRecord> records;
+    std::string names;
+    records.reserve(metadata.size());
+
+    for (const auto &meta : metadata) {
+        records.push_back({names.size(), meta.size, meta.offset, meta.orig_size, 
+                        meta.compressed_size});
+        names.append(meta.file_name);
+        names.push_back('\0');
+    }
+
+    MetadataHeader header;
+    std::memcpy(header.magic, metadata_magic, sizeof(header.magic));
+    header.version = metadata_version;
+    header.record_size = sizeof(MetadataRecord);
+    header.n_records = records.size();
+    header.names_size = names.size();
+
+    std::ofstream file(file_name, std::ios::binary);
+
+    if (!file) {
+        throw std::runtime_error("Failed to open file for writing: " + file_name.string());
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()), 
+               records.size() * sizeof(MetadataRecord));
+    file.write(names.data(), names.size());
+    file.close();
+}
+
+/**
+ * @brief Maps a binary metadata file and checks its header.
+ *
+ * Only the header is read: records and names are accessed in place when
+ * requested, so loading does not depend on the number of records.
+ *
+ * @param file_name  Path to the binary metadata file.
+ *
+ * @throws std::runtime_error If the file cannot be mapped, is not a binary 
+ *         metadata file, or is shorter than its header states.
+ */
+MetadataTable::MetadataTable(const std::filesystem::path file_name) : file(file_name) {
+
+    const MetadataHeader *header = reinterpret_cast<const MetadataHeader*>(file.data());
+
+    if (file.size() < sizeof(MetadataHeader) || 
+        std::memcmp(header->magic, metadata_magic, sizeof(metadata_magic)) != 0) {
+        throw std::runtime_error("Not a binary metadata file: " + file_name.string());
+    }
+
+    if (header->version != metadata_version || header->record_size != sizeof(MetadataRecord)) {
+        throw std::runtime_error("Unsupported binary metadata version in file: " + 
+                                file_name.string());
+    }
+
+    n_records = header->n_records;
+    names_size = header->names_size;
+
+    size_t records_size = n_records * sizeof(MetadataRecord);
+
+    if (file.size() - sizeof(MetadataHeader) < records_size || 
+        file.size() - sizeof(MetadataHeader) - records_size < names_size) {
+        throw std::runtime_error("Truncated binary metadata file: " + file_name.string());
+    }
+
+    records = reinterpret_cast<const MetadataRecord*>(file.data() + sizeof(MetadataHeader));
+    names = reinterpret_cast<const char*>(file.data() + sizeof(MetadataHeader) + records_size);
+}
+
+/**
+ * @brief Returns the file name of a record.
+ *
+ * @param index  Index of the record.
+ * @return A view of the file name, valid as long as the table.
+ *
+ * @throws std::runtime_error If the name lies outside the table of names.
+ */
+std::string_view MetadataTable::fileName(size_t index) const {
+
+    uint64_t name_offset = records[index].name_offset;
+
+    const void *end = name_offset < names_size ? 
+                      std::memchr(names + name_offset, '\0', names_size - name_offset) : nullptr;
+
+    if (!end) {
+        throw std::runtime_error("Invalid file name offset in metadata record " + 
+                                std::to_string(index));
+    }
+    return std::string_view(names + name_offset, static_cast<const char*>(end) - (names + name_offset));
+}
+
+/**
+ * @brief Returns a record as a CTMeta object.
+ *
+ * @param index  Index of the record.
+ * @return The CTMeta object of the record.
+ */
+CTMeta MetadataTable::operator[](size_t index) const {
+
+    const MetadataRecord &entry = records[index];
+
+    return {std::string(fileName(index)), entry.size, entry.offset, entry.orig_size, 
+            entry.compressed_size};
+}
@@ -0,0 +1,167 @@
+/**
+* @file gzip.cpp
+* @brief This module defines functions to decompress gzip files.
+* @author Iole Bolognesi
+*
+* A gzip file may hold several members one after the other, as written by
+* concatenating gzip files or by parallel compressors such as pigz; they are
+* decompressed in turn and their contents concatenated. The size stored in
+* the trailer of the last member is used to size the output buffer, which
+* grows if the contents turn out larger.
+*/
+
+#include "gzip.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+/**
+ * @brief Returns whether a file is gzip-compressed, judging by its extension.
+ *
+ * @param file_name  Path to the file.
+ */
+bool isGzipFile(const std::filesystem::path &file_name){
+
+    return file_name.extension() == ".gz";
+}
+
+/**
+ * @brief Returns the name of a gzip file once decompressed.
+ *
+ * @param file_name  Path to the file.
+ * @return The file name without its .gz extension; the file name itself
+ *         if it has no such extension.
+ */
+std::filesystem::path gunzippedName(const std::filesystem::path &file_name){
+
+    return isGzipFile(file_name) ? file_name.filename().stem() : file_name.filename();
+}
+
+/**
+ * @brief Decompresses gzip data into memory.
+ *
+ * @param input   Pointer to the gzip data.
+ * @param length  Size of the gzip data.
+ * @param source  Name of the data, for error messages.
+ * @return The decompressed contents.
+ *
+ * @throws std::runtime_error if the data is not valid gzip or is truncated,
+ *         or if built without zlib.
+ */
+ByteBuffer gunzip(const unsigned char *input, size_t length, const std::string &source){
+
+#ifdef USE_ZLIB
+    /* The trailer ends with the size of the last member, modulo 2^32. It is
+    not validated, so the hint is capped at deflate's maximum ratio and the
+    buffer grows below if the data really is larger */
+    size_t size_hint = 0;
+    if (length >= 18) {
+        const unsigned char *trailer = input + length - 4;
+        size_hint = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) |
+                    (static_cast<size_t>(trailer[3]) << 24);
+    }
+
+    ByteBuffer output(std::max(std::min<size_t>(size_hint, length * 1032), length));
+    size_t produced = 0;
+
+    z_stream stream{};
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+        throw std::runtime_error("Failed to initialise zlib for: " + source);
+    }
+
+    /* zlib counts bytes with unsigned int, so larger buffers are fed in pieces */
+    const size_t max_piece = std::numeric_limits<unsigned int>::max();
+    size_t consumed = 0;
+    int result = Z_OK;
+
+    while (true) {
+
+        if (produced == output.size()) {
+            output.resize(output.size() * 2);
+        }
+
+        size_t in_piece = std::min(length - consumed, max_piece);
+        size_t out_piece = std::min(output.size() - produced, max_piece);
+
+        stream.next_in = const_cast<unsigned char*>(input + consumed);
+        stream.avail_in = static_cast<unsigned int>(in_piece);
+        stream.next_out = output.data() + produced;
+        stream.avail_out = static_cast<unsigned int>(out_piece);
+
+        result = inflate(&stream, Z_NO_FLUSH);
+
+        consumed += in_piece - stream.avail_in;
+        produced += out_piece - stream.avail_out;
+
+        if (result == Z_STREAM_END) {
+            /* Another member may follow */
+            if (consumed == length) {
+                break;
+            }
+            inflateReset(&stream);
+        }
+        else if (result == Z_BUF_ERROR && consumed == length && stream.avail_out > 0) {
+            break;
+        }
+        else if (result != Z_OK && result != Z_BUF_ERROR) {
+            break;
+        }
+    }
+
+    inflateEnd(&stream);
+
+    if (result != Z_STREAM_END) {
+        throw std::runtime_error("Invalid or truncated gzip data: " + source);
+    }
+
+    output.resize(produced);
+    return output;
+#else
+    (void)input;
+    (void)length;
+    throw std::runtime_error("Built without zlib, rebuild with USE_ZLIB=1 to decompress: " + source);
+#endif
+}
+
+/**
+ * @brief Reads a file and decompresses it if it is gzip-compressed.
+ *
+ * @param file_name  Path to the file.
+ * @param file_size  Size of the file.
+ * @param mapped     Whether to decompress straight from the mapped pages
+ *                   of the file, or else from a copy read into memory.
+ * @return The decompressed contents of a gzip file; the contents of any
+ *         other file as they are.
+ *
+ * @throws std::runtime_error if the file cannot be read, changed size, or
+ *         cannot be decompressed.
+ */
+ByteBuffer gunzipFile(const std::filesystem::path &file_name, size_t file_size, bool mapped){
+
+    if (mapped) {
+        MappedFile mapping(file_name);
+
+        if (mapping.size() != file_size) {
+            throw std::runtime_error("File changed size during decompression: " +
+                                    file_name.string());
+        }
+
+        if (isGzipFile(file_name)) {
+            return gunzip(mapping.data(), file_size, file_name.string());
+        }
+        return ByteBuffer(mapping.data(), mapping.data() + file_size);
+    }
+
+    ByteBuffer contents(file_size);
+    loadFileInto(file_name, contents.data(), file_size);
+
+    if (isGzipFile(file_name)) {
+        return gunzip(contents.data(), file_size, file_name.string());
+    }
+    return contents;
+}
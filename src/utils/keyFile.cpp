@@ -0,0 +1,299 @@
+/**
+* @file keyFile.cpp
+* @brief This module defines functions to save and load the key file
+* of the parallel pipeline.
+* @author Iole Bolognesi
+*
+* This module provides the functions that write the keys and IVs of all
+* processes to a single binary file and read them back, so that the
+* cipher-text can be decrypted by another program, e.g. bin/decrypt or
+* bin/extract, in a separate job.
+*
+* With a passphrase, the records are encrypted with AES-256-GCM under a key
+* encryption key derived from the passphrase and a random salt with
+* PBKDF2-HMAC-SHA256 (version 2). The headers are authenticated along with
+* the records, so a wrong passphrase or a modified file is detected.
+*/
+
+#include "keyFile.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <aes.h>
+#include <gcm.h>
+#include <osrng.h>
+#include <pwdbased.h>
+#include <sha.h>
+
+static const char key_file_magic[8] = {'C', 'T', 'K', 'E', 'Y', 'S', '\0', '\0'};
+static const uint32_t key_file_version = 1;
+static const uint32_t protected_key_file_version = 2;
+
+/* Size of the tag following the wrapped records (bytes) */
+static const size_t key_file_tag_bytes = 16;
+
+/**
+ * @brief Derives the key wrapping the records of a protected key file.
+ *
+ * @param passphrase  Passphrase of the key file.
+ * @param wrap        Header holding the salt and the number of iterations.
+ * @return The 32-byte key encryption key.
+ */
+static CryptoPP::SecByteBlock deriveWrappingKey(const std::string &passphrase,
+                                                const KeyWrapHeader &wrap){
+
+    CryptoPP::SecByteBlock wrapping_key(32);
+    CryptoPP::PKCS5_PBKDF2_HMAC<CryptoPP::SHA256> pbkdf;
+
+    pbkdf.DeriveKey(wrapping_key, wrapping_key.size(), 0,
+                    reinterpret_cast<const unsigned char*>(passphrase.data()), passphrase.size(),
+                    wrap.salt, sizeof(wrap.salt), wrap.kdf_iterations);
+
+    return wrapping_key;
+}
+
+/**
+ * @brief Concatenates the headers of a protected key file, which are 
+ * authenticated with its records.
+ */
+static CryptoPP::SecByteBlock wrapAssociatedData(const KeyFileHeader &header,
+                                                const KeyWrapHeader &wrap){
+
+    CryptoPP::SecByteBlock associated_data(sizeof(header) + sizeof(wrap));
+    std::memcpy(associated_data.data(), &header, sizeof(header));
+    std::memcpy(associated_data.data() + sizeof(header), &wrap, sizeof(wrap));
+
+    return associated_data;
+}
+
+/**
+ * @brief Writes a buffer to a file descriptor, retrying partial writes.
+ *
+ * @param fd         File descriptor to write to.
+ * @param data       Pointer to the bytes to write.
+ * @param length     Number of bytes to write.
+ * @param file_name  Path to the file, for error messages.
+ *
+ * @throws std::runtime_error if the write fails.
+ */
+static void writeAll(int fd, const unsigned char *data, size_t length,
+                    const std::filesystem::path &file_name){
+
+    while (length > 0) {
+        ssize_t result = write(fd, data, length);
+
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0) {
+            throw std::runtime_error("Failed to write key file: " + file_name.string() +
+                                    " (" + std::strerror(errno) + ")");
+        }
+        data += result;
+        length -= result;
+    }
+}
+
+/**
+ * @brief Saves the keys and IVs of all processes to a key file.
+ *
+ * The file is created with read and write permission for its owner only,
+ * and replaces any previous file of the same name. Given a passphrase, the
+ * records are wrapped and can only be loaded with the same passphrase.
+ *
+ * @param file_name   Path to the key file.
+ * @param records     Key followed by IV of each process, in rank order.
+ * @param n_keys      Number of processes.
+ * @param key_size    Size in bytes of each key.
+ * @param iv_size     Size in bytes of each IV.
+ * @param passphrase  Passphrase protecting the records; empty to store 
+ *                    them as they are.
+ *
+ * @throws std::runtime_error if the file cannot be written or the records
+ *         do not match the given sizes.
+ */
+void saveKeyFile(const std::filesystem::path file_name, const CryptoPP::SecByteBlock &records,
+                size_t n_keys, size_t key_size, size_t iv_size, 
+                const std::string &passphrase) {
+
+    if (records.size() != n_keys * (key_size + iv_size)) {
+        throw std::runtime_error("Key records do not match the number of keys");
+    }
+
+    KeyFileHeader header;
+    std::memcpy(header.magic, key_file_magic, sizeof(header.magic));
+    header.version = passphrase.empty() ? key_file_version : protected_key_file_version;
+    header.n_keys = n_keys;
+    header.key_size = key_size;
+    header.iv_size = iv_size;
+
+    /* Records written to the file, wrapped if protected */
+    CryptoPP::SecByteBlock body = records;
+    KeyWrapHeader wrap;
+
+    if (!passphrase.empty()) {
+
+        CryptoPP::AutoSeededRandomPool prng;
+        wrap.kdf_iterations = KEY_FILE_KDF_ITERATIONS;
+        prng.GenerateBlock(wrap.salt, sizeof(wrap.salt));
+        prng.GenerateBlock(wrap.nonce, sizeof(wrap.nonce));
+
+        CryptoPP::SecByteBlock wrapping_key = deriveWrappingKey(passphrase, wrap);
+        CryptoPP::SecByteBlock associated_data = wrapAssociatedData(header, wrap);
+
+        CryptoPP::GCM<CryptoPP::AES>::Encryption encryption;
+        encryption.SetKeyWithIV(wrapping_key, wrapping_key.size(), wrap.nonce, sizeof(wrap.nonce));
+
+        body.resize(records.size() + key_file_tag_bytes);
+        encryption.EncryptAndAuthenticate(body.data(), body.data() + records.size(), 
+                                        key_file_tag_bytes, wrap.nonce, sizeof(wrap.nonce), 
+                                        associated_data, associated_data.size(),
+                                        records, records.size());
+    }
+
+    int fd = open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file for writing: " + file_name.string() +
+                                " (" + std::strerror(errno) + ")");
+    }
+
+    try {
+        /* An existing file keeps its permissions when opened */
+        if (fchmod(fd, S_IRUSR | S_IWUSR) != 0) {
+            throw std::runtime_error("Failed to restrict permissions of key file: " +
+                                    file_name.string());
+        }
+        writeAll(fd, reinterpret_cast<const unsigned char*>(&header), sizeof(header), file_name);
+        if (!passphrase.empty()) {
+            writeAll(fd, reinterpret_cast<const unsigned char*>(&wrap), sizeof(wrap), file_name);
+        }
+        writeAll(fd, body.data(), body.size(), file_name);
+    }
+    catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+}
+
+/**
+ * @brief Loads the keys and IVs of all processes from a key file.
+ *
+ * @param file_name   Path to the key file.
+ * @param passphrase  Passphrase of a protected key file; ignored otherwise.
+ * @return The key and IV of each process, in rank order.
+ *
+ * @throws std::runtime_error if the file cannot be read, is not a key file,
+ *         or is protected and the passphrase is missing or wrong.
+ */
+std::vector<ProcessKey> loadKeyFile(const std::filesystem::path file_name, 
+                                    const std::string &passphrase) {
+
+    std::ifstream file(file_name, std::ios::binary);
+
+    if (!file) {
+        throw std::runtime_error("Failed to open file for reading: " + file_name.string());
+    }
+
+    KeyFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (!file || std::memcmp(header.magic, key_file_magic, sizeof(key_file_magic)) != 0) {
+        throw std::runtime_error("Not a key file: " + file_name.string());
+    }
+
+    if (header.version != key_file_version && header.version != protected_key_file_version) {
+        throw std::runtime_error("Unsupported key file version in file: " + file_name.string());
+    }
+
+    bool wrapped = header.version == protected_key_file_version;
+
+    if (wrapped && passphrase.empty()) {
+        throw std::runtime_error("Key file is protected by a passphrase, give it with "
+                                "--passphrase-file: " + file_name.string());
+    }
+
+    KeyWrapHeader wrap;
+    if (wrapped) {
+        file.read(reinterpret_cast<char*>(&wrap), sizeof(wrap));
+    }
+
+    size_t record_size = static_cast<size_t>(header.key_size) + header.iv_size;
+    CryptoPP::SecByteBlock records(header.n_keys * record_size);
+    CryptoPP::SecByteBlock body(records.size() + (wrapped ? key_file_tag_bytes : 0));
+
+    file.read(reinterpret_cast<char*>(body.data()), body.size());
+
+    if (!file) {
+        throw std::runtime_error("Truncated key file: " + file_name.string());
+    }
+
+    if (wrapped) {
+
+        CryptoPP::SecByteBlock wrapping_key = deriveWrappingKey(passphrase, wrap);
+        CryptoPP::SecByteBlock associated_data = wrapAssociatedData(header, wrap);
+
+        CryptoPP::GCM<CryptoPP::AES>::Decryption decryption;
+        decryption.SetKeyWithIV(wrapping_key, wrapping_key.size(), wrap.nonce, sizeof(wrap.nonce));
+
+        if (!decryption.DecryptAndVerify(records.data(), body.data() + records.size(), 
+                                        key_file_tag_bytes, wrap.nonce, sizeof(wrap.nonce),
+                                        associated_data, associated_data.size(),
+                                        body.data(), records.size())) {
+            throw std::runtime_error("Wrong passphrase or modified key file: " + 
+                                    file_name.string());
+        }
+    }
+    else {
+        std::memcpy(records.data(), body.data(), records.size());
+    }
+
+    std::vector<ProcessKey> keys(header.n_keys);
+
+    for (size_t n = 0; n < keys.size(); n++) {
+        const unsigned char *record = records.data() + n * record_size;
+        keys[n].key.Assign(record, header.key_size);
+        keys[n].iv.Assign(record + header.key_size, header.iv_size);
+    }
+
+    return keys;
+}
+
+/**
+ * @brief Loads a passphrase from the first line of a file, so that it does
+ * not appear on the command line.
+ *
+ * @param file_name  Path to the passphrase file.
+ * @return The passphrase, without its line ending.
+ *
+ * @throws std::runtime_error if the file cannot be read or the passphrase 
+ *         is empty.
+ */
+std::string loadPassphrase(const std::filesystem::path file_name) {
+
+    std::ifstream file(file_name);
+
+    if (!file) {
+        throw std::runtime_error("Failed to open file for reading: " + file_name.string());
+    }
+
+    std::string passphrase;
+    std::getline(file, passphrase);
+
+    if (!passphrase.empty() && passphrase.back() == '\r') {
+        passphrase.pop_back();
+    }
+
+    if (passphrase.empty()) {
+        throw std::runtime_error("Empty passphrase in file: " + file_name.string());
+    }
+
+    return passphrase;
+}
@@ -1,7 +1,8 @@
 /** 
 * @file parsing.cpp
 * @brief This module defines a function to convert a string to a 
-* CyperType enum (defined in file CipherFactory.hpp)
+* CipherType (defined in file CipherFactory.hpp) and the functions
+* that parse the command-line options of the pipelines. 
 * @author Iole Bolognesi 
 * 
 */
@@ -9,92 +10,480 @@
 #include "parsing.hpp"
 #include "CipherFactory.hpp"
 
+#include <charconv>
+
 /**
- * @brief Converts a string to its corresponding CipherType enum value.
+ * @brief Converts a string to its corresponding CipherType value.
  *
- * This function returns the CipherType enum corresponding to the
- * input cipher name. If the given string does not match any valid cipher, 
- * the function prints an error message and terminates the program. 
+ * This function returns the CipherType corresponding to the input cipher 
+ * name, looked up in cipher_registry. If the given string does not match 
+ * any valid cipher, the function prints an error message listing the 
+ * valid ciphers and terminates the program. 
  *
  * @param input  Cipher name string to be converted.
  * @param rank   MPI rank of the calling process
- * @return The   corresponding CipherType enumeration constant.
+ * @return The   corresponding CipherType.
  */
-CipherType getEnumFromString(std::string_view input,int rank) {
-
-    /* ---------- AES ---------- */
-    if (input == "AES_CBC")         return AES_CBC;
-    if (input == "AES_CFB")         return AES_CFB;
-    if (input == "AES_OFB")         return AES_OFB;
-    if (input == "AES_CTR")         return AES_CTR;
-    if (input == "AES_ECB")         return AES_ECB;
-
-    /* ------- SERPENT --------- */
-    if (input == "SERPENT_CBC")     return Serpent_CBC;
-    if (input == "SERPENT_CFB")     return Serpent_CFB;
-    if (input == "SERPENT_OFB")     return Serpent_OFB;
-    if (input == "SERPENT_CTR")     return Serpent_CTR;
-    if (input == "SERPENT_ECB")     return Serpent_ECB;
-
-     /* -------- MARS ---------- */
-    if (input == "MARS_CBC")        return Mars_CBC;
-    if (input == "MARS_CFB")        return Mars_CFB;
-    if (input == "MARS_OFB")        return Mars_OFB;
-    if (input == "MARS_CTR")        return Mars_CTR;
-    if (input == "MARS_ECB")        return Mars_ECB;
-
-    /* -------- RC6 ----------- */
-    if (input == "RC6_CBC")         return RC6_CBC;
-    if (input == "RC6_CFB")         return RC6_CFB;
-    if (input == "RC6_OFB")         return RC6_OFB;
-    if (input == "RC6_CTR")         return RC6_CTR;
-    if (input == "RC6_ECB")         return RC6_ECB;
-
-    /* ------- TWOFISH --------- */
-    if (input == "TWOFISH_CBC")     return Twofish_CBC;
-    if (input == "TWOFISH_CFB")     return Twofish_CFB;
-    if (input == "TWOFISH_OFB")     return Twofish_OFB;
-    if (input == "TWOFISH_CTR")     return Twofish_CTR;
-    if (input == "TWOFISH_ECB")     return Twofish_ECB;
-
-    /* ------ CHACHA20 -------- */
-    if (input == "CHACHA20")        return ChaCha20;
+CipherType getCipherType(std::string_view input, int rank) {
+
+    std::optional<size_t> row = findCipher(input);
+
+    if (row) {
+        return *row;
+    }
 
     if(rank==0){
         std::cerr << "You entered an invalid cipher: " << input << std::endl;
         std::cerr << "VALID CIPHERS ARE:" << std::endl;
-        
-        std::cerr << "AES_CBC" << std::endl;
-        std::cerr << "AES_CFB" << std::endl;
-        std::cerr << "AES_OFB" << std::endl;
-        std::cerr << "AES_CTR" << std::endl;
-        std::cerr << "AES_ECB" << std::endl;
-
-        std::cerr << "SERPENT_CBC" << std::endl;
-        std::cerr << "SERPENT_CFB" << std::endl;
-        std::cerr << "SERPENT_OFB" << std::endl;
-        std::cerr << "SERPENT_CTR" << std::endl;
-        std::cerr << "SERPENT_ECB" << std::endl;
-
-        std::cerr << "MARS_CBC" << std::endl;
-        std::cerr << "MARS_CFB" << std::endl;
-        std::cerr << "MARS_OFB" << std::endl;
-        std::cerr << "MARS_CTR" << std::endl;
-        std::cerr << "MARS_ECB" << std::endl;
-
-        std::cerr << "RC6_CBC" << std::endl;
-        std::cerr << "RC6_CFB" << std::endl;
-        std::cerr << "RC6_OFB" << std::endl;
-        std::cerr << "RC6_CTR" << std::endl;
-        std::cerr << "RC6_ECB" << std::endl;
-
-        std::cerr << "TWOFISH_CBC" << std::endl;
-        std::cerr << "TWOFISH_CFB" << std::endl;
-        std::cerr << "TWOFISH_OFB" << std::endl;
-        std::cerr << "TWOFISH_CTR" << std::endl;
-        std::cerr << "TWOFISH_ECB" << std::endl;
-
-        std::cerr << "CHACHA20" << std::endl;
+
+        for (const CipherEntry &entry : cipher_registry) {
+            std::cerr << entry.name << std::endl;
+        }
     }
     std::exit(1);
+}
+
+/**
+ * @brief Converts a string to an unsigned integer.
+ *
+ * @param input  String holding a base-10 unsigned integer.
+ * @return The parsed value; std::nullopt if the string is not a valid number.
+ */
+static std::optional<size_t> parseNumber(std::string_view input) {
+
+    size_t value = 0;
+    auto [end, error] = std::from_chars(input.data(), input.data() + input.size(), value);
+
+    if (error != std::errc() || end != input.data() + input.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+/**
+ * @brief Converts a size string to a number of bytes.
+ *
+ * The string is an unsigned integer optionally followed by one of the 
+ * suffixes K, M, or G (powers of 1024), e.g. "4M". 
+ *
+ * @param input  Size string to be converted.
+ * @return The size in bytes; std::nullopt if the string is not a valid size.
+ */
+static std::optional<size_t> parseByteSize(std::string_view input) {
+
+    size_t multiplier = 1;
+
+    if (!input.empty()) {
+        switch (input.back()) {
+            case 'K': multiplier = 1024UL; break;
+            case 'M': multiplier = 1024UL * 1024; break;
+            case 'G': multiplier = 1024UL * 1024 * 1024; break;
+        }
+        if (multiplier != 1) {
+            input.remove_suffix(1);
+        }
+    }
+
+    std::optional<size_t> value = parseNumber(input);
+    if (!value) {
+        return std::nullopt;
+    }
+    return *value * multiplier;
+}
+
+/**
+ * @brief Parses the command-line arguments of a pipeline.
+ *
+ * The first two arguments are positional: the dataset directory and the 
+ * cipher name. They can be followed by any of the options listed by 
+ * printOptionsUsage, given in the form --name=value. 
+ *
+ * @param argc  Command-line arguments' count.
+ * @param argv  Command-line arguments' vector.
+ * @return The parsed options; std::nullopt if an argument is missing, 
+ *         unknown, or has an invalid value.
+ */
+std::optional<PipelineOptions> parseOptions(int argc, char *argv[]) {
+
+    if (argc < 3) {
+        return std::nullopt;
+    }
+
+    PipelineOptions options;
+    options.dataset_directory = argv[1];
+    options.cipher_name = argv[2];
+
+    for (int i = 3; i < argc; i++) {
+
+        std::string_view argument{argv[i]};
+        size_t separator = argument.find('=');
+
+        if (argument.substr(0, 2) != "--" || separator == std::string_view::npos) {
+            std::cerr << "Invalid option: " << argument << std::endl;
+            return std::nullopt;
+        }
+
+        std::string_view name = argument.substr(2, separator - 2);
+        std::string_view value = argument.substr(separator + 1);
+
+        if (name == "threads") {
+            std::optional<size_t> n_threads = parseNumber(value);
+            if (!n_threads || *n_threads == 0) {
+                std::cerr << "Invalid number of threads: " << value << std::endl;
+                return std::nullopt;
+            }
+            options.n_threads = *n_threads;
+        }
+        else if (name == "threading") {
+            if (value == "chunks")      options.threading = THREADS_CHUNKS;
+            else if (value == "files")  options.threading = THREADS_FILES;
+            else {
+                std::cerr << "Invalid threading type: " << value << std::endl;
+                return std::nullopt;
+            }
+        }
+        else if (name == "chunk-size") {
+            std::optional<size_t> chunk_bytes = parseByteSize(value);
+            if (!chunk_bytes || *chunk_bytes == 0) {
+                std::cerr << "Invalid chunk size: " << value << std::endl;
+                return std::nullopt;
+            }
+            options.chunk_bytes = *chunk_bytes;
+        }
+        else if (name == "partition") {
+            if (value == "files")       options.partition = PARTITION_FILES;
+            else if (value == "bytes")  options.partition = PARTITION_BYTES;
+            else {
+                std::cerr << "Invalid partition: " << value << std::endl;
+                return std::nullopt;
+            }
+        }
+        else if (name == "input") {
+            if (value == "read")        options.input = INPUT_READ;
+            else if (value == "mmap")   options.input = INPUT_MMAP;
+            else if (value == "uring")  options.input = INPUT_URING;
+            else {
+                std::cerr << "Invalid input type: " << value << std::endl;
+                return std::nullopt;
+            }
+        }
+        else if (name == "stream-buffer") {
+            std::optional<size_t> stream_bytes = parseByteSize(value);
+            if (!stream_bytes || (*stream_bytes != 0 && *stream_bytes < N_BLOCK_BYTES)) {
+                std::cerr << "Invalid stream buffer size: " << value << std::endl;
+                return std::nullopt;
+            }
+            /* Buffers hold whole cipher blocks */
+            options.stream_bytes = *stream_bytes - (*stream_bytes % N_BLOCK_BYTES);
+        }
+        else if (name == "read-depth") {
+            std::optional<size_t> read_depth = parseNumber(value);
+            if (!read_depth || *read_depth == 0) {
+                std::cerr << "Invalid read depth: " << value << std::endl;
+                return std::nullopt;
+            }
+            options.read_depth = *read_depth;
+        }
+        else if (name == "metadata-format") {
+            if (value == "binary")      options.metadata_format = METADATA_BINARY;
+            else if (value == "text")   options.metadata_format = METADATA_TEXT;
+            else {
+                std::cerr << "Invalid metadata format: " << value << std::endl;
+                return std::nullopt;
+            }
+        }
+        else if (name == "writers") {
+            std::optional<size_t> n_writers = parseNumber(value);
+            if (!n_writers) {
+                std::cerr << "Invalid number of writers: " << value << std::endl;
+                return std::nullopt;
+            }
+            options.n_writers = *n_writers;
+        }
+        else if (name == "queue-depth") {
+            std::optional<size_t> queue_depth = parseNumber(value);
+            if (!queue_depth || *queue_depth == 0) {
+                std::cerr << "Invalid queue depth: " << value << std::endl;
+                return std::nullopt;
+            }
+            options.queue_depth = *queue_depth;
+        }
+        else if (name == "io-mode") {
+            if (value == "reopen")          options.io_mode = IO_REOPEN;
+            else if (value == "persistent") options.io_mode = IO_PERSISTENT;
+            else {
+                std::cerr << "Invalid I/O mode: " << value << std::endl;
+                return std::nullopt;
+            }
+        }
+        else if (name == "key-file") {
+            if (value.empty()) {
+                std::cerr << "Invalid key file: " << value << std::endl;
+                return std::nullopt;
+            }
+            options.key_file = value;
+        }
+        else if (name == "passphrase-file") {
+            if (value.empty()) {
+                std::cerr << "Invalid passphrase file: " << value << std::endl;
+                return std::nullopt;
+            }
+            options.passphrase_file = value;
+        }
+        else if (name == "adios-config") {
+            if (value.empty()) {
+                std::cerr << "Invalid ADIOS 2 config file: " << value << std::endl;
+                return std::nullopt;
+            }
+            options.adios_config = value;
+        }
+        else if (name == "aggregate") {
+            std::optional<size_t> ranks_per_aggregator = parseNumber(value);
+            if (!ranks_per_aggregator) {
+                std::cerr << "Invalid number of processes per aggregator: " << value << std::endl;
+                return std::nullopt;
+            }
+            options.ranks_per_aggregator = *ranks_per_aggregator;
+        }
+        else if (name == "io-backend") {
+            if (value == "adios")       options.io_backend = BACKEND_ADIOS;
+            else if (value == "mpiio")  options.io_backend = BACKEND_MPIIO;
+            else if (value == "posix")  options.io_backend = BACKEND_POSIX;
+            else {
+                std::cerr << "Invalid I/O backend: " << value << std::endl;
+                return std::nullopt;
+            }
+        }
+        else if (name == "mpiio-hints") {
+            options.mpiio_hints = value;
+        }
+        else if (name == "posix-io") {
+            if (value == "buffered")    options.direct_io = false;
+            else if (value == "direct") options.direct_io = true;
+            else {
+                std::cerr << "Invalid POSIX I/O type: " << value << std::endl;
+                return std::nullopt;
+            }
+        }
+        else if (name == "compress") {
+            if (value == "none")        options.codec = CODEC_NONE;
+            else if (value == "zstd")   options.codec = CODEC_ZSTD;
+            else if (value == "lz4")    options.codec = CODEC_LZ4;
+            else {
+                std::cerr << "Invalid codec: " << value << std::endl;
+                return std::nullopt;
+            }
+        }
+        else if (name == "compress-level") {
+            std::optional<size_t> compression_level = parseNumber(value);
+            if (!compression_level || *compression_level > 100) {
+                std::cerr << "Invalid compression level: " << value << std::endl;
+                return std::nullopt;
+            }
+            options.compression_level = static_cast<int>(*compression_level);
+        }
+        else if (name == "gzip") {
+            if (value == "opaque")          options.gunzip = false;
+            else if (value == "decompress") options.gunzip = true;
+            else {
+                std::cerr << "Invalid gzip handling: " << value << std::endl;
+                return std::nullopt;
+            }
+        }
+        else {
+            std::cerr << "Unknown option: --" << name << std::endl;
+            return std::nullopt;
+        }
+    }
+
+    /* Files are compressed whole before encryption, not piece by piece */
+    if (options.codec != CODEC_NONE && options.input == INPUT_URING) {
+        std::cerr << "--compress cannot be combined with --input=uring" << std::endl;
+        return std::nullopt;
+    }
+
+    /* Gzip files are likewise decompressed whole */
+    if (options.gunzip && options.input == INPUT_URING) {
+        std::cerr << "--gzip=decompress cannot be combined with --input=uring" << std::endl;
+        return std::nullopt;
+    }
+
+    /* Streamed buffers are written as they are encrypted, with no staging */
+    if (options.ranks_per_aggregator > 0 && options.stream_bytes > 0) {
+        std::cerr << "--aggregate cannot be combined with --stream-buffer" << std::endl;
+        return std::nullopt;
+    }
+
+    /* The passphrase protects the key file */
+    if (!options.passphrase_file.empty() && options.key_file.empty()) {
+        std::cerr << "--passphrase-file requires --key-file" << std::endl;
+        return std::nullopt;
+    }
+
+    return options;
+}
+
+/**
+ * @brief Prints the optional command-line arguments of the pipelines.
+ */
+void printOptionsUsage(void) {
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --threads=<n>             Threads per process used to encrypt and decrypt "
+                 "(CTR modes, CHACHA20 and GCM modes, or any mode for files threading). Default: 1" << std::endl;
+    std::cout << "  --threading=<type>        Split each large file into chunks across threads "
+                 "(chunks) or give each thread whole files (files). Default: chunks" << std::endl;
+    std::cout << "  --chunk-size=<size>       Bytes per chunk, with optional K/M/G suffix. "
+                 "Default: 4M" << std::endl;
+    std::cout << "  --partition=<type>        Split the dataset across processes by number of "
+                 "files (files) or by number of bytes (bytes). Parallel pipeline only. "
+                 "Default: files" << std::endl;
+    std::cout << "  --stream-buffer=<size>    Overlap encryption with the cipher-text write, "
+                 "using two buffers of this size (0 disables). Parallel pipeline only. "
+                 "Default: 0" << std::endl;
+    std::cout << "  --input=<type>            Read dataset files into heap buffers (read), "
+                 "encrypt them directly from memory-mapped pages (mmap), or keep many reads "
+                 "in flight through io_uring (uring). Default: read" << std::endl;
+    std::cout << "  --read-depth=<n>          Reads in flight with --input=uring. "
+                 "Default: 32" << std::endl;
+    std::cout << "  --metadata-format=<type>  Write the metadata file in binary (binary) or as "
+                 "text (text). Serial pipeline only. Default: binary" << std::endl;
+    std::cout << "  --writers=<n>             Threads writing decrypted files in the background "
+                 "(0 writes them synchronously). Default: 0" << std::endl;
+    std::cout << "  --queue-depth=<n>         Decrypted files waiting to be written before "
+                 "decryption blocks. Default: 16" << std::endl;
+    std::cout << "  --io-mode=<type>          Open the ADIOS 2 files for every iteration (reopen) "
+                 "or once, writing and reading one step per iteration (persistent). "
+                 "Parallel pipeline only. Default: reopen" << std::endl;
+    std::cout << "  --key-file=<path>         Save the key and IV of every process to this file, "
+                 "for bin/decrypt and bin/extract. Parallel pipeline only. Default: not saved, "
+                 "required by bin/encrypt" << std::endl;
+    std::cout << "  --passphrase-file=<path>  Protect the key file with the passphrase on the "
+                 "first line of this file. Default: unprotected" << std::endl;
+    std::cout << "  --adios-config=<path>     ADIOS 2 XML or YAML config file setting the engine "
+                 "and parameters of each IO. Parallel pipeline only. Default: none" << std::endl;
+    std::cout << "  --aggregate=<n>           Stage the cipher-text of every n processes of a "
+                 "node in shared memory, written by one aggregator (0 disables). Parallel "
+                 "pipeline only. Default: 0" << std::endl;
+    std::cout << "  --io-backend=<type>       Write and read the metadata and cipher-text "
+                 "through ADIOS 2 (adios), collective MPI-IO (mpiio) or a file per process "
+                 "(posix). Parallel pipeline only. Default: adios" << std::endl;
+    std::cout << "  --mpiio-hints=<hints>     Comma-separated MPI-IO hints, e.g. "
+                 "cb_nodes=4,cb_buffer_size=16777216,striping_factor=8,striping_unit=1048576. "
+                 "Parallel pipeline only. Default: none" << std::endl;
+    std::cout << "  --posix-io=<type>         Write through the page cache (buffered) or "
+                 "bypass it with O_DIRECT and aligned buffers (direct), for the cipher-text "
+                 "of the serial pipeline and with --io-backend=posix. Default: buffered" << std::endl;
+    std::cout << "  --compress=<codec>        Compress each file before encrypting it with "
+                 "zstd (zstd) or lz4 (lz4), if built in, or not at all (none). "
+                 "Default: none" << std::endl;
+    std::cout << "  --compress-level=<n>      Compression level of zstd, or acceleration of "
+                 "lz4 (0 for the library default). Default: 0" << std::endl;
+    std::cout << "  --gzip=<type>             Encrypt .gz files as they are (opaque) or "
+                 "decompress them first, across threads (decompress). Default: opaque" << std::endl;
+}
+
+/**
+ * @brief Parses the command-line arguments of the extraction tool.
+ *
+ * The first two arguments are the cipher name and the key file. They are 
+ * followed by file names or glob patterns, and by any of the options listed
+ * by printExtractUsage, given in the form --name=value. 
+ *
+ * @param argc  Command-line arguments' count.
+ * @param argv  Command-line arguments' vector.
+ * @return The parsed options, with no pattern if none was given; 
+ *         std::nullopt if an argument is missing or an option is unknown.
+ */
+std::optional<ExtractOptions> parseExtractOptions(int argc, char *argv[]) {
+
+    if (argc < 3) {
+        return std::nullopt;
+    }
+
+    ExtractOptions options;
+    options.cipher_name = argv[1];
+    options.key_file = argv[2];
+
+    for (int i = 3; i < argc; i++) {
+
+        std::string_view argument{argv[i]};
+        size_t separator = argument.find('=');
+
+        if (argument.substr(0, 2) != "--") {
+            options.patterns.emplace_back(argument);
+            continue;
+        }
+
+        if (separator == std::string_view::npos) {
+            std::cerr << "Invalid option: " << argument << std::endl;
+            return std::nullopt;
+        }
+
+        std::string_view name = argument.substr(2, separator - 2);
+        std::string_view value = argument.substr(separator + 1);
+
+        if (name == "data")             options.data_file = value;
+        else if (name == "metadata")    options.metadata_file = value;
+        else if (name == "output")      options.output_directory = value;
+        else if (name == "adios-config") options.adios_config = value;
+        else if (name == "mpiio-hints") options.mpiio_hints = value;
+        else if (name == "passphrase-file") options.passphrase_file = value;
+        else if (name == "io-backend") {
+            if (value == "adios")       options.io_backend = BACKEND_ADIOS;
+            else if (value == "mpiio")  options.io_backend = BACKEND_MPIIO;
+            else if (value == "posix")  options.io_backend = BACKEND_POSIX;
+            else {
+                std::cerr << "Invalid I/O backend: " << value << std::endl;
+                return std::nullopt;
+            }
+        }
+        else if (name == "posix-io") {
+            if (value == "buffered")    options.direct_io = false;
+            else if (value == "direct") options.direct_io = true;
+            else {
+                std::cerr << "Invalid POSIX I/O type: " << value << std::endl;
+                return std::nullopt;
+            }
+        }
+        else if (name == "compress") {
+            if (value == "none")        options.codec = CODEC_NONE;
+            else if (value == "zstd")   options.codec = CODEC_ZSTD;
+            else if (value == "lz4")    options.codec = CODEC_LZ4;
+            else {
+                std::cerr << "Invalid codec: " << value << std::endl;
+                return std::nullopt;
+            }
+        }
+        else {
+            std::cerr << "Unknown option: --" << name << std::endl;
+            return std::nullopt;
+        }
+    }
+
+    return options;
+}
+
+/**
+ * @brief Prints the optional command-line arguments of the extraction tool.
+ */
+void printExtractUsage(void) {
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --data=<path>             ADIOS 2 cipher-text file. "
+                 "Default: output/encryptedData" << std::endl;
+    std::cout << "  --metadata=<path>         ADIOS 2 metadata file. "
+                 "Default: output/metadata" << std::endl;
+    std::cout << "  --output=<directory>      Directory receiving the decrypted files. "
+                 "Default: output/extractedData" << std::endl;
+    std::cout << "  --adios-config=<path>     ADIOS 2 XML or YAML config file setting the engine "
+                 "and parameters of each IO. Default: none" << std::endl;
+    std::cout << "  --io-backend=<type>       Backend that wrote the files: ADIOS 2 (adios) "
+                 "MPI-IO (mpiio) or a file per process (posix). Default: adios" << std::endl;
+    std::cout << "  --mpiio-hints=<hints>     Comma-separated MPI-IO hints. "
+                 "Default: none" << std::endl;
+    std::cout << "  --posix-io=<type>         Read with --io-backend=posix through the page "
+                 "cache (buffered) or with O_DIRECT (direct). Default: buffered" << std::endl;
+    std::cout << "  --compress=<codec>        Codec the files were compressed with: zstd "
+                 "(zstd), lz4 (lz4) or none (none). Default: none" << std::endl;
+    std::cout << "  --passphrase-file=<path>  File holding on its first line the passphrase of "
+                 "a protected key file. Default: none" << std::endl;
 }
\ No newline at end of file